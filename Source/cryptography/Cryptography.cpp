@@ -32,6 +32,10 @@
 #include <com/com.h>
 #include <plugins/Types.h>
 
+#ifndef CRYPTOGRAPHY_INGEST_BUFFER
+#define CRYPTOGRAPHY_INGEST_BUFFER 8192
+#endif
+
 namespace Thunder {
 namespace Implementation {
 
@@ -169,20 +173,36 @@ namespace Implementation {
         END_INTERFACE_MAP
 
     public:
+        // The lock only guards the accessor, the calls themselves are not
+        // serialized so multiple threads can use the cipher at the same time.
         int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[],
             const uint32_t inputLength, const uint8_t input[],
             const uint32_t maxOutputLength, uint8_t output[]) const override
         {
-            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
-            return (_accessor != nullptr) ? _accessor->Encrypt(ivLength, iv, inputLength, input, maxOutputLength, output) : 0;
+            int32_t result = 0;
+            Exchange::ICipher* accessor = Accessor();
+
+            if (accessor != nullptr) {
+                result = accessor->Encrypt(ivLength, iv, inputLength, input, maxOutputLength, output);
+                accessor->Release();
+            }
+
+            return (result);
         }
 
         int32_t Decrypt(const uint8_t ivLength, const uint8_t iv[],
             const uint32_t inputLength, const uint8_t input[],
             const uint32_t maxOutputLength, uint8_t output[]) const override
         {
-            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
-            return (_accessor != nullptr) ? _accessor->Decrypt(ivLength, iv, inputLength, input, maxOutputLength, output) : 0;
+            int32_t result = 0;
+            Exchange::ICipher* accessor = Accessor();
+
+            if (accessor != nullptr) {
+                result = accessor->Decrypt(ivLength, iv, inputLength, input, maxOutputLength, output);
+                accessor->Release();
+            }
+
+            return (result);
         }
 
         void Unlink()
@@ -194,21 +214,43 @@ namespace Implementation {
             }
         }
 
+    private:
+        Exchange::ICipher* Accessor() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+            if (_accessor != nullptr) {
+                _accessor->AddRef();
+            }
+            return (_accessor);
+        }
+
     private:
         mutable Core::CriticalSection _adminLock;
         Exchange::ICipher* _accessor;
     };
 
+    // Every Generate() on a remote random source is a round trip, so small
+    // requests are served from a buffer that is filled with one request.
+    // Bytes are handed out once and wiped, a forked child drops the bytes
+    // its parent fetched.
     class RPCRandomImpl : public Exchange::IRandom {
+    private:
+        static constexpr uint16_t BufferSize = 512;
+
     public:
         RPCRandomImpl(Exchange::IRandom* random)
             : _accessor(random)
+            , _process(::getpid())
+            , _available(0)
         {
             if (_accessor != nullptr) {
                 _accessor->AddRef();
             }
         }
-        ~RPCRandomImpl() override = default;
+        ~RPCRandomImpl() override
+        {
+            ::memset(_buffer, 0, sizeof(_buffer));
+        }
 
         BEGIN_INTERFACE_MAP(RPCRandomImpl)
         INTERFACE_ENTRY(Exchange::IRandom)
@@ -217,8 +259,38 @@ namespace Implementation {
     public:
         uint16_t Generate(const uint16_t length, uint8_t data[]) const override
         {
+            uint16_t result = 0;
+
             Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
-            return (_accessor != nullptr ? _accessor->Generate(length, data) : 0);
+
+            if (_accessor != nullptr) {
+                if (_process != ::getpid()) {
+                    Drop();
+                    _process = ::getpid();
+                }
+
+                if (length > (BufferSize / 4)) {
+                    result = _accessor->Generate(length, data);
+                } else {
+                    if (_available < length) {
+                        Drop();
+
+                        if (_accessor->Generate(sizeof(_buffer), _buffer) == sizeof(_buffer)) {
+                            _available = sizeof(_buffer);
+                        }
+                    }
+
+                    if (_available >= length) {
+                        uint8_t* source = &_buffer[sizeof(_buffer) - _available];
+                        ::memcpy(data, source, length);
+                        ::memset(source, 0, length);
+                        _available -= length;
+                        result = length;
+                    }
+                }
+            }
+
+            return (result);
         }
 
         void Unlink()
@@ -228,21 +300,48 @@ namespace Implementation {
                 _accessor->Release();
                 _accessor = nullptr;
             }
+            Drop();
+        }
+
+    private:
+        void Drop() const
+        {
+            ::memset(_buffer, 0, sizeof(_buffer));
+            _available = 0;
         }
 
     private:
         mutable Core::CriticalSection _adminLock;
         Exchange::IRandom* _accessor;
+        mutable pid_t _process;
+        mutable uint16_t _available;
+        mutable uint8_t _buffer[BufferSize];
     };
 
+    // Every Ingest() on a remote hash is a round trip, so small pieces of
+    // data are collected here and ingested in one call when the buffer is
+    // full or the hash is calculated. The buffer size can be overruled with
+    // the CRYPTOGRAPHY_INGEST_BUFFER environment variable, 0 disables it.
+    // A buffered ingest is reported as accepted; if ingesting the buffer
+    // fails later on, the next Ingest() or Calculate() reports the failure.
+    // With CRYPTOGRAPHY_INGEST_BUFFER set, small ingests are collected and
+    // sent to the server in one call. A collected ingest is accepted before
+    // it reaches the server, so if sending it fails that is reported by the
+    // next Calculate() of the same digest, which then returns 0. Data
+    // ingested after such a failure is dropped, Ingest() does not fail.
     class RPCHashImpl : public Exchange::IHash {
     public:
         RPCHashImpl(Exchange::IHash* hash)
             : _accessor(hash)
+            , _buffer()
+            , _capacity(BufferSize())
+            , _failed(false)
         {
             if (_accessor != nullptr) {
                 _accessor->AddRef();
             }
+
+            _buffer.reserve(_capacity);
         }
         ~RPCHashImpl() override = default;
 
@@ -254,15 +353,52 @@ namespace Implementation {
         /* Ingest data into the hash calculator (multiple calls possible) */
         uint32_t Ingest(const uint32_t length, const uint8_t data[] /* @length:length */) override
         {
+            uint32_t result = 0;
+
             Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
-            return (_accessor != nullptr ? _accessor->Ingest(length, data) : 0);
+
+            if (_accessor != nullptr) {
+                if ((_buffer.size() + length) > _capacity) {
+                    Flush();
+                }
+
+                if (_failed == true) {
+                    // This digest is lost already, Calculate() reports it.
+                    result = length;
+                } else if (length >= _capacity) {
+                    // Would not fit anyway, no need to copy it.
+                    result = _accessor->Ingest(length, data);
+                } else {
+                    _buffer.insert(_buffer.end(), data, data + length);
+                    result = length;
+                }
+            }
+
+            return (result);
         }
 
         /* Calculate the hash from all ingested data */
         uint8_t Calculate(const uint8_t maxLength, uint8_t data[] /* @out @maxlength:maxLength */) override
         {
+            uint8_t result = 0;
+
             Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
-            return (_accessor != nullptr ? _accessor->Calculate(maxLength, data) : 0);
+
+            if (_accessor != nullptr) {
+                Flush();
+
+                result = _accessor->Calculate(maxLength, data);
+
+                if (_failed == true) {
+                    // Part of the data is missing from this digest, but the
+                    // remote side is done with it, so the next one is fine.
+                    ::memset(data, 0, result);
+                    result = 0;
+                    _failed = false;
+                }
+            }
+
+            return (result);
         }
 
         void Unlink()
@@ -272,11 +408,43 @@ namespace Implementation {
                 _accessor->Release();
                 _accessor = nullptr;
             }
+            _buffer.clear();
+        }
+
+    private:
+        static uint32_t BufferSize()
+        {
+            uint32_t result = CRYPTOGRAPHY_INGEST_BUFFER;
+            string value;
+
+            if (Core::SystemInfo::GetEnvironment(_T("CRYPTOGRAPHY_INGEST_BUFFER"), value) == true) {
+                result = static_cast<uint32_t>(::strtoul(value.c_str(), nullptr, 10));
+            }
+
+            return (result);
+        }
+
+        // Runs with the lock taken.
+        void Flush()
+        {
+            if (_buffer.empty() == false) {
+                const uint32_t length = static_cast<uint32_t>(_buffer.size());
+
+                if ((_failed == false) && (_accessor->Ingest(length, _buffer.data()) != length)) {
+                    TRACE_L1("Failed to ingest %d buffered bytes", length);
+                    _failed = true;
+                }
+
+                _buffer.clear();
+            }
         }
 
     private:
         Core::CriticalSection _adminLock;
         Exchange::IHash* _accessor;
+        std::vector<uint8_t> _buffer;
+        const uint32_t _capacity;
+        bool _failed;
     };
 
     class RPCVaultImpl : public Exchange::IVault {
@@ -0,0 +1,279 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace Implementation {
+
+// Maps vault ids to their elements. An id is a slot index (low 16 bits)
+// with the generation of that slot (high 16 bits), so a lookup is a plain
+// index and a stale id never matches a reused slot.
+//
+// Lookups are lock free: a Reference counts itself as a reader on the
+// slot, Remove() detaches the element and waits for the readers of that
+// slot to drain before deleting it. Inserts and removes are serialized,
+// the wait for readers happens outside of that lock. A slot only becomes
+// free again once its readers are gone, and a slot that has used up its
+// generations is retired, so an id is never handed out twice.
+//
+// Ids up to 0xFFFF (generation 0) are reserved for well known elements,
+// put in place with Insert(element, id). All other ids are handed out
+// with a generation of 0x8000 and up, i.e. they are 0x80000000 or higher.
+template <typename ELEMENT>
+class HandleTable {
+private:
+    static constexpr uint16_t SegmentSize = 256;
+    static constexpr uint16_t Segments = 256;
+    static constexpr uint16_t FirstGeneration = 0x8000;
+
+    struct Slot {
+        std::atomic<uint32_t> Handle;
+        std::atomic<uint32_t> Readers;
+        std::atomic<ELEMENT*> Element;
+        uint16_t Generation;
+    };
+
+public:
+    class Reference {
+    public:
+        Reference(const Reference&) = delete;
+        Reference& operator=(const Reference&) = delete;
+        Reference() = delete;
+
+        Reference(const HandleTable& table, const uint32_t handle)
+            : _slot(table.Find(handle))
+            , _element(nullptr)
+        {
+            if (_slot != nullptr) {
+                _slot->Readers.fetch_add(1);
+
+                ELEMENT* element = _slot->Element.load();
+
+                // The handle is cleared before the element is detached and
+                // set after a new one is attached, so if it still matches the
+                // element is the one this handle refers to.
+                if ((element != nullptr) && (_slot->Handle.load() == handle)) {
+                    _element = element;
+                } else {
+                    _slot->Readers.fetch_sub(1);
+                    _slot = nullptr;
+                }
+            }
+        }
+        ~Reference()
+        {
+            if (_slot != nullptr) {
+                _slot->Readers.fetch_sub(1);
+            }
+        }
+
+    public:
+        bool IsValid() const
+        {
+            return (_element != nullptr);
+        }
+        const ELEMENT* operator->() const
+        {
+            return (_element);
+        }
+        const ELEMENT& operator*() const
+        {
+            return (*_element);
+        }
+
+    private:
+        Slot* _slot;
+        const ELEMENT* _element;
+    };
+
+public:
+    HandleTable(const HandleTable&) = delete;
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    HandleTable()
+        : _lock()
+        , _free()
+        , _used(1) // slot 0 is never used, id 0 is invalid
+    {
+        for (uint16_t index = 0; index < Segments; index++) {
+            _segments[index].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ~HandleTable()
+    {
+        for (uint16_t index = 0; index < Segments; index++) {
+            Slot* segment = _segments[index].load();
+
+            if (segment != nullptr) {
+                for (uint16_t slot = 0; slot < SegmentSize; slot++) {
+                    delete segment[slot].Element.load();
+                }
+
+                delete[] segment;
+            }
+        }
+    }
+
+public:
+    // Takes ownership of the element, returns its id or 0 if the table is
+    // full (or the requested well known id is taken).
+    uint32_t Insert(ELEMENT* element, const uint16_t wellKnown = 0)
+    {
+        uint32_t handle = 0;
+
+        ASSERT(element != nullptr);
+
+        _lock.Lock();
+
+        uint32_t index = wellKnown;
+
+        if (index == 0) {
+            if (_free.empty() == false) {
+                index = _free.back();
+                _free.pop_back();
+            } else if (_used < (static_cast<uint32_t>(SegmentSize) * Segments)) {
+                index = _used++;
+            }
+        } else if (index >= _used) {
+            // Slots skipped on the way are left for later inserts.
+            for (uint32_t skipped = _used; skipped < index; skipped++) {
+                _free.push_back(static_cast<uint16_t>(skipped));
+            }
+            _used = (index + 1);
+        } else {
+            typename std::vector<uint16_t>::iterator entry(std::find(_free.begin(), _free.end(), static_cast<uint16_t>(index)));
+
+            if (entry != _free.end()) {
+                _free.erase(entry);
+            } else {
+                index = 0;
+            }
+        }
+
+        if (index != 0) {
+            Slot& slot = Allocate(static_cast<uint16_t>(index));
+
+            if (wellKnown != 0) {
+                slot.Generation = 0;
+            } else if (slot.Generation < FirstGeneration) {
+                slot.Generation = FirstGeneration;
+            } else {
+                // Slots at the last generation are not freed, see Remove().
+                ASSERT(slot.Generation != 0xFFFF);
+                slot.Generation++;
+            }
+
+            handle = ((static_cast<uint32_t>(slot.Generation) << 16) | index);
+
+            slot.Element.store(element);
+            slot.Handle.store(handle);
+        } else {
+            delete element;
+        }
+
+        _lock.Unlock();
+
+        return (handle);
+    }
+
+    bool Remove(const uint32_t handle)
+    {
+        ELEMENT* element = nullptr;
+
+        _lock.Lock();
+
+        Slot* slot = Find(handle);
+
+        if ((slot != nullptr) && (slot->Handle.load() == handle)) {
+            slot->Handle.store(0);
+            element = slot->Element.exchange(nullptr);
+        }
+
+        _lock.Unlock();
+
+        if (element != nullptr) {
+            // Lookups in flight may still use it, they are short. Until it
+            // is freed below, the slot can not be handed out again.
+            while (slot->Readers.load() != 0) {
+                std::this_thread::yield();
+            }
+
+            delete element;
+
+            if ((handle >> 16) != 0xFFFF) {
+                _lock.Lock();
+                _free.push_back(static_cast<uint16_t>(handle & 0xFFFF));
+                _lock.Unlock();
+            }
+        }
+
+        return (element != nullptr);
+    }
+
+private:
+    Slot* Find(const uint32_t handle) const
+    {
+        Slot* result = nullptr;
+        const uint16_t index = (handle & 0xFFFF);
+
+        if (index != 0) {
+            Slot* segment = _segments[index / SegmentSize].load(std::memory_order_acquire);
+
+            if (segment != nullptr) {
+                result = &segment[index % SegmentSize];
+            }
+        }
+
+        return (result);
+    }
+
+    Slot& Allocate(const uint16_t index)
+    {
+        Slot* segment = _segments[index / SegmentSize].load(std::memory_order_relaxed);
+
+        if (segment == nullptr) {
+            segment = new Slot[SegmentSize];
+
+            for (uint16_t slot = 0; slot < SegmentSize; slot++) {
+                segment[slot].Handle.store(0, std::memory_order_relaxed);
+                segment[slot].Readers.store(0, std::memory_order_relaxed);
+                segment[slot].Element.store(nullptr, std::memory_order_relaxed);
+                segment[slot].Generation = 0;
+            }
+
+            _segments[index / SegmentSize].store(segment, std::memory_order_release);
+        }
+
+        return (segment[index % SegmentSize]);
+    }
+
+private:
+    Thunder::Core::CriticalSection _lock;
+    std::atomic<Slot*> _segments[Segments];
+    std::vector<uint16_t> _free;
+    uint32_t _used;
+};
+
+} // namespace Implementation
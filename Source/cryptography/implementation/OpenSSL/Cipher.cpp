@@ -32,9 +32,21 @@
 
 #include <limits.h>
 
+#include "ContextPool.h"
 #include "Vault.h"
 
+struct CipherStreamImplementation {
+    virtual int32_t Update(const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) = 0;
+
+    virtual int32_t Final(const uint32_t maxOutputLength, uint8_t output[]) = 0;
+
+    virtual ~CipherStreamImplementation() {}
+};
+
 struct CipherImplementation {
+    virtual CipherStreamImplementation* Stream(const bool encrypt, const uint8_t ivLength, const uint8_t iv[]) const = 0;
+
     virtual int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const = 0;
@@ -43,6 +55,16 @@ struct CipherImplementation {
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const = 0;
 
+    virtual int32_t EncryptAEAD(const uint8_t ivLength, const uint8_t iv[],
+        const uint32_t aadLength, const uint8_t aad[],
+        const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) const = 0;
+
+    virtual int32_t DecryptAEAD(const uint8_t ivLength, const uint8_t iv[],
+        const uint32_t aadLength, const uint8_t aad[],
+        const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) const = 0;
+
     virtual ~CipherImplementation() {}
 };
 
@@ -60,18 +82,113 @@ std::string GetSSLError()
 }
 
 class Cipher : public CipherImplementation {
+private:
+    // Runs on a pooled context for its whole lifetime, so the chaining
+    // state is carried over between the chunks. It must not outlive the
+    // cipher it was created from.
+    class CipherStream : public CipherStreamImplementation {
+    public:
+        CipherStream(const CipherStream&) = delete;
+        CipherStream& operator=(const CipherStream&) = delete;
+        CipherStream() = delete;
+
+        CipherStream(const Cipher& parent, const bool encrypt, EVP_CIPHER_CTX* context)
+            : _parent(parent)
+            , _context(context)
+            , _encrypt(encrypt)
+            , _blockSize(EVP_CIPHER_CTX_block_size(context))
+            , _finished(false)
+        {
+            ASSERT(context != nullptr);
+        }
+        ~CipherStream() override
+        {
+            _parent.Release(_encrypt, _context);
+        }
+
+    public:
+        int32_t Update(const uint32_t inputLength, const uint8_t input[],
+            const uint32_t maxOutputLength, uint8_t output[]) override
+        {
+            int32_t result = 0;
+
+            ASSERT(input != nullptr);
+
+            const uint32_t required = inputLength + (_blockSize > 1 ? _blockSize : 0);
+
+            if (_finished == true) {
+                TRACE_L1("Stream is already finished");
+            } else if (maxOutputLength < required) {
+                TRACE_L1("Too small output buffer, expected: %i bytes", required);
+                result = -static_cast<int32_t>(required);
+            } else {
+                int len = 0;
+
+                ERR_clear_error();
+
+                if (EVP_CipherUpdate(_context, output, &len, input, inputLength) == 0) {
+                    TRACE_L1("EVP_CipherUpdate() failed: %s", GetSSLError().c_str());
+                    _finished = true;
+                } else {
+                    result = len;
+                }
+            }
+
+            return (result);
+        }
+
+        int32_t Final(const uint32_t maxOutputLength, uint8_t output[]) override
+        {
+            int32_t result = 0;
+
+            if (_finished == true) {
+                TRACE_L1("Stream is already finished");
+            } else if (maxOutputLength < _blockSize) {
+                TRACE_L1("Too small output buffer, expected: %i bytes", _blockSize);
+                result = -static_cast<int32_t>(_blockSize);
+            } else {
+                int len = 0;
+
+                ERR_clear_error();
+                _finished = true;
+
+                if (EVP_CipherFinal_ex(_context, output, &len) == 0) {
+                    TRACE_L1("EVP_CipherFinal_ex() failed: %s", GetSSLError().c_str());
+                } else {
+                    result = len;
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        const Cipher& _parent;
+        EVP_CIPHER_CTX* _context;
+        bool _encrypt;
+        uint32_t _blockSize;
+        bool _finished;
+    };
+
 public:
     Cipher(const Cipher&) = delete;
     Cipher& operator=(const Cipher) = delete;
     Cipher() = delete;
 
-    Cipher(const Implementation::Vault* vault, const EVP_CIPHER* cipher, const uint32_t keyId, const uint8_t keyLength, const uint8_t ivLength)
-        : _context(nullptr)
-        , _vault(vault)
-        , _cipher(cipher)
+    // The key is exported from the vault once and expanded into an
+    // encryption and a decryption context. Every operation after that
+    // only resets the IV, the key schedule is reused. These keyed contexts
+    // are templates: operations run on pooled clones, so the cipher can be
+    // used from multiple threads at the same time. A non-zero tag length
+    // makes this an AEAD cipher, the tag is appended to the ciphertext.
+    Cipher(const Implementation::Vault* vault, const EVP_CIPHER* cipher, const uint32_t keyId, const uint8_t keyLength, const uint8_t ivLength, const uint8_t tagLength = 0)
+        : _encryptContext(nullptr)
+        , _decryptContext(nullptr)
+        , _encryptPool()
+        , _decryptPool()
         , _keyId(keyId)
-        , _keyLength(keyLength)
         , _ivLength(ivLength)
+        , _tagLength(tagLength)
     {
         ASSERT(vault != nullptr);
         ASSERT(cipher != nullptr);
@@ -79,34 +196,155 @@ public:
         ASSERT(keyLength != 0);
         ASSERT(ivLength != 0);
 
-        _context = EVP_CIPHER_CTX_new();
-        ASSERT(_context != nullptr);
+        uint8_t* keyBuf = reinterpret_cast<uint8_t*>(ALLOCA(keyLength));
+        ASSERT(keyBuf != nullptr);
+
+        // Not asserted: a key that can not be exported makes creation fail.
+        uint16_t length = vault->Export(keyId, keyLength, keyBuf, true);
+
+        if (length != keyLength) {
+            TRACE_L1("Failed to retrieve a valid encryption key from id 0x%08x", keyId);
+        } else {
+            _encryptContext = Schedule(cipher, keyBuf, true);
+            _decryptContext = Schedule(cipher, keyBuf, false);
+        }
+
+        ::memset(keyBuf, 0x00, keyLength);
     }
 
     ~Cipher() override
     {
-        if (_context != nullptr) {
-            EVP_CIPHER_CTX_free(_context);
+        if (_encryptContext != nullptr) {
+            EVP_CIPHER_CTX_free(_encryptContext);
+        }
+        if (_decryptContext != nullptr) {
+            EVP_CIPHER_CTX_free(_decryptContext);
+        }
+    }
+
+    bool IsValid() const
+    {
+        return ((_encryptContext != nullptr) && (_decryptContext != nullptr));
+    }
+
+    CipherStreamImplementation* Stream(const bool encrypt, const uint8_t ivLength, const uint8_t iv[]) const override
+    {
+        CipherStreamImplementation* result = nullptr;
+        EVP_CIPHER_CTX* context = nullptr;
+
+        ASSERT(iv != nullptr);
+
+        if (_tagLength != 0) {
+            TRACE_L1("Streaming is not supported for authenticated ciphers");
+        } else if (ivLength != _ivLength) {
+            TRACE_L1("Invalid IV length! [%i]", ivLength);
+        } else if ((context = Acquire(encrypt)) == nullptr) {
+            TRACE_L1("No valid encryption context for key id 0x%08x", _keyId);
+        } else {
+            ERR_clear_error();
+
+            if (EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, iv, -1) == 0) {
+                TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+                Release(encrypt, context);
+            } else {
+                result = new CipherStream(*this, encrypt, context);
+            }
         }
+
+        return (result);
     }
 
     int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const override
     {
-        return (Operation(true, ivLength, iv, inputLength, input, maxOutputLength, output));
+        return (Operation(true, ivLength, iv, 0, nullptr, inputLength, input, maxOutputLength, output));
     }
 
     int32_t Decrypt(const uint8_t ivLength, const uint8_t iv[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const override
     {
-        return (Operation(false, ivLength, iv, inputLength, input, maxOutputLength, output));
+        return (Operation(false, ivLength, iv, 0, nullptr, inputLength, input, maxOutputLength, output));
+    }
+
+    int32_t EncryptAEAD(const uint8_t ivLength, const uint8_t iv[],
+        const uint32_t aadLength, const uint8_t aad[],
+        const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) const override
+    {
+        int32_t result = 0;
+
+        if (_tagLength == 0) {
+            TRACE_L1("Additional data requires an authenticated cipher");
+        } else {
+            result = Operation(true, ivLength, iv, aadLength, aad, inputLength, input, maxOutputLength, output);
+        }
+
+        return (result);
+    }
+
+    int32_t DecryptAEAD(const uint8_t ivLength, const uint8_t iv[],
+        const uint32_t aadLength, const uint8_t aad[],
+        const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) const override
+    {
+        int32_t result = 0;
+
+        if (_tagLength == 0) {
+            TRACE_L1("Additional data requires an authenticated cipher");
+        } else {
+            result = Operation(false, ivLength, iv, aadLength, aad, inputLength, input, maxOutputLength, output);
+        }
+
+        return (result);
     }
 
 private:
+    static EVP_CIPHER_CTX* Schedule(const EVP_CIPHER* cipher, const uint8_t key[], const bool encrypt)
+    {
+        EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+        ASSERT(context != nullptr);
+
+        if (context != nullptr) {
+            ERR_clear_error();
+
+            if (EVP_CipherInit_ex(context, cipher, nullptr, key, nullptr, encrypt) == 0) {
+                TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+                EVP_CIPHER_CTX_free(context);
+                context = nullptr;
+            }
+        }
+
+        return (context);
+    }
+
+    EVP_CIPHER_CTX* Acquire(const bool encrypt) const
+    {
+        EVP_CIPHER_CTX* context = (encrypt ? _encryptPool : _decryptPool).Acquire();
+
+        if (context == nullptr) {
+            context = EVP_CIPHER_CTX_new();
+            ASSERT(context != nullptr);
+
+            if ((context != nullptr) && (EVP_CIPHER_CTX_copy(context, (encrypt ? _encryptContext : _decryptContext)) == 0)) {
+                TRACE_L1("EVP_CIPHER_CTX_copy() failed: %s", GetSSLError().c_str());
+                EVP_CIPHER_CTX_free(context);
+                context = nullptr;
+            }
+        }
+
+        return (context);
+    }
+
+    void Release(const bool encrypt, EVP_CIPHER_CTX* context) const
+    {
+        (encrypt ? _encryptPool : _decryptPool).Release(context);
+    }
+
     int32_t Operation(bool encrypt,
         const uint8_t ivLength, const uint8_t iv[],
+        const uint32_t aadLength, const uint8_t aad[],
         const uint32_t inputLength, const uint8_t input[],
         const uint32_t maxOutputLength, uint8_t output[]) const
     {
@@ -116,60 +354,85 @@ private:
         ASSERT(ivLength != 0);
         ASSERT(input != nullptr);
         ASSERT(inputLength != 0);
+        ASSERT((aadLength == 0) || (aad != nullptr));
+
+        EVP_CIPHER_CTX* context = nullptr;
+
+        // For AEAD the tag follows the ciphertext: it is added on encryption
+        // and taken off (and verified) on decryption.
+        const uint32_t dataLength = (encrypt ? inputLength : (inputLength - _tagLength));
+        const uint32_t outputLength = (encrypt ? (inputLength + _tagLength) : dataLength);
 
         if (ivLength != _ivLength) {
             TRACE_L1("Invalid IV length! [%i]", ivLength);
-        } else if (maxOutputLength < inputLength) {
+        } else if ((encrypt == false) && (inputLength < _tagLength)) {
+            TRACE_L1("Input too short to hold the authentication tag [%i]", inputLength);
+        } else if ((_tagLength != 0) && (maxOutputLength < outputLength)) {
+            TRACE_L1("Too small output buffer, expected: %i bytes", outputLength);
+            result = (-static_cast<int32_t>(outputLength));
+        } else if ((_tagLength == 0) && (maxOutputLength < inputLength)) {
             // Note: Pitfall, AES CBC/ECB will use padding
             TRACE_L1("Too small output buffer, expected: %i bytes", inputLength);
             result = (-static_cast<int32_t>(inputLength + (16 - (inputLength % 16))));
+        } else if ((context = Acquire(encrypt)) == nullptr) {
+            TRACE_L1("No valid encryption context for key id 0x%08x", _keyId);
         } else {
-            uint8_t* keyBuf = reinterpret_cast<uint8_t*>(ALLOCA(_keyLength));
-            ASSERT(keyBuf != nullptr);
-
-            uint16_t length = _vault->Export(_keyId, _keyLength, keyBuf, true);
-            ASSERT(length != 0);
-
-            if (length != _keyLength) {
-                TRACE_L1("Failed to retrieve a valid encryption key from id 0x%08x", _keyId);
+            ERR_clear_error();
+            int len = 0;
+
+            // Keeps the cipher and the expanded key, only the IV (and any
+            // block state left by the previous operation) is reset.
+            if (EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, iv, -1) == 0) {
+                TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+            } else if ((aadLength != 0) && (EVP_CipherUpdate(context, nullptr, &len, aad, aadLength) == 0)) {
+                TRACE_L1("EVP_CipherUpdate() failed on the additional data: %s", GetSSLError().c_str());
+            } else if ((encrypt == false) && (_tagLength != 0)
+                && (EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_TAG, _tagLength, const_cast<uint8_t*>(input + dataLength)) == 0)) {
+                TRACE_L1("EVP_CIPHER_CTX_ctrl() failed to set the tag: %s", GetSSLError().c_str());
             } else {
-                ERR_clear_error();
-                int len = 0;
-                int initResult = EVP_CipherInit_ex(_context, _cipher, nullptr, keyBuf, iv, encrypt);
-                ::memset(keyBuf, 0x00, length);
+                len = 0;
 
-                if (initResult == 0) {
-                    TRACE_L1("EVP_CipherInit_ex() failed: %s", GetSSLError().c_str());
+                if ((dataLength != 0) && (EVP_CipherUpdate(context, output, &len, input, dataLength) == 0)) {
+                    TRACE_L1("EVP_CipherUpdate() failed: %s", GetSSLError().c_str());
                 } else {
-                    if (EVP_CipherUpdate(_context, output, &len, input, inputLength) == 0) {
-                        TRACE_L1("EVP_CipherUpdate() failed: %s", GetSSLError().c_str());
+                    result = len;
+                    len = 0;
+                    // Note: EVP_CipherFinal_ex() can still write to the output buffer!
+                    // For AEAD decryption this is where the tag is verified.
+                    if (EVP_CipherFinal_ex(context, (output + result), &len) == 0) {
+                        TRACE_L1("EVP_CipherFinal_ex() failed: %s", GetSSLError().c_str());
+                        result = 0;
+                    } else if ((encrypt == true) && (_tagLength != 0)
+                        && (EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_GET_TAG, _tagLength, (output + result + len)) == 0)) {
+                        TRACE_L1("EVP_CIPHER_CTX_ctrl() failed to get the tag: %s", GetSSLError().c_str());
+                        result = 0;
                     } else {
-                        result = len;
-                        len = 0;
-                        // Note: EVP_CipherFinal_ex() can still write to the output buffer!
-                        if (EVP_CipherFinal_ex(_context, (output + result), &len) == 0) {
-                            TRACE_L1("EVP_CipherFinal_ex() failed: %s", GetSSLError().c_str());
-                            result = 0;
-                        } else {
-                            result += len;
-                            TRACE_L2("Completed %scryption, input size: %i, output size: %i",
-                                (encrypt ? "en" : "de"), inputLength, result);
-                        }
+                        result += len + (encrypt ? _tagLength : 0);
+                        TRACE_L2("Completed %scryption, input size: %i, output size: %i",
+                            (encrypt ? "en" : "de"), inputLength, result);
                     }
                 }
+
+                if ((result == 0) && (encrypt == false) && (_tagLength != 0)) {
+                    // Do not hand out plaintext that failed authentication.
+                    ::memset(output, 0x00, dataLength);
+                }
             }
+
+            Release(encrypt, context);
         }
 
         return (result);
     }
 
 private:
-    EVP_CIPHER_CTX* _context;
-    const Implementation::Vault* _vault;
-    const EVP_CIPHER* _cipher;
+    EVP_CIPHER_CTX* _encryptContext;
+    EVP_CIPHER_CTX* _decryptContext;
+    mutable ContextPool<EVP_CIPHER_CTX, EVP_CIPHER_CTX_free> _encryptPool;
+    mutable ContextPool<EVP_CIPHER_CTX, EVP_CIPHER_CTX_free> _decryptPool;
     uint32_t _keyId;
-    uint8_t _keyLength;
     uint8_t _ivLength;
+    uint8_t _tagLength;
 };
 
 const EVP_CIPHER* AESCipher(const uint8_t keySize, const aes_mode mode)
@@ -178,10 +441,10 @@ const EVP_CIPHER* AESCipher(const uint8_t keySize, const aes_mode mode)
 
     typedef const EVP_CIPHER* (*cipherfn)(void);
 
-    static const cipherfn cipherTable[][7] = {
-        { EVP_aes_128_ecb, EVP_aes_128_cbc, EVP_aes_128_ofb, EVP_aes_128_cfb1, EVP_aes_128_cfb8, EVP_aes_128_cfb128, EVP_aes_128_ctr },
-        { EVP_aes_192_ecb, EVP_aes_192_cbc, EVP_aes_192_ofb, EVP_aes_192_cfb1, EVP_aes_192_cfb8, EVP_aes_192_cfb128, EVP_aes_192_ctr },
-        { EVP_aes_256_ecb, EVP_aes_256_cbc, EVP_aes_256_ofb, EVP_aes_256_cfb1, EVP_aes_256_cfb8, EVP_aes_256_cfb128, EVP_aes_256_ctr }
+    static const cipherfn cipherTable[][8] = {
+        { EVP_aes_128_ecb, EVP_aes_128_cbc, EVP_aes_128_ofb, EVP_aes_128_cfb1, EVP_aes_128_cfb8, EVP_aes_128_cfb128, EVP_aes_128_ctr, EVP_aes_128_gcm },
+        { EVP_aes_192_ecb, EVP_aes_192_cbc, EVP_aes_192_ofb, EVP_aes_192_cfb1, EVP_aes_192_cfb8, EVP_aes_192_cfb128, EVP_aes_192_ctr, EVP_aes_192_gcm },
+        { EVP_aes_256_ecb, EVP_aes_256_cbc, EVP_aes_256_ofb, EVP_aes_256_cfb1, EVP_aes_256_cfb8, EVP_aes_256_cfb128, EVP_aes_256_ctr, EVP_aes_256_gcm }
     };
 
     uint8_t idx = -1;
@@ -207,6 +470,9 @@ const EVP_CIPHER* AESCipher(const uint8_t keySize, const aes_mode mode)
     case aes_mode::AES_MODE_CTR:
         idx = 6;
         break;
+    case aes_mode::AES_MODE_GCM:
+        idx = 7;
+        break;
     default:
         TRACE_L1("Unsupported AES cipher block mode %i", mode);
     }
@@ -244,7 +510,40 @@ struct CipherImplementation* cipher_create_aes(const struct VaultImplementation*
         const EVP_CIPHER* evpcipher = Implementation::AESCipher(static_cast<uint8_t>(keyLength), mode);
         ASSERT(evpcipher != nullptr);
         if (evpcipher != nullptr) {
-            cipher = new Implementation::Cipher(vaultImpl, evpcipher, key_id, static_cast<uint8_t>(keyLength), 16);
+            Implementation::Cipher* implementation = (mode == aes_mode::AES_MODE_GCM
+                    ? new Implementation::Cipher(vaultImpl, evpcipher, key_id, static_cast<uint8_t>(keyLength), 12, 16)
+                    : new Implementation::Cipher(vaultImpl, evpcipher, key_id, static_cast<uint8_t>(keyLength), 16));
+
+            if (implementation->IsValid() == true) {
+                cipher = implementation;
+            } else {
+                delete implementation;
+            }
+        }
+    }
+
+    return (cipher);
+}
+
+struct CipherImplementation* cipher_create_chacha20_poly1305(const struct VaultImplementation* vault, const uint32_t key_id)
+{
+    ASSERT(vault != nullptr);
+
+    CipherImplementation* cipher = nullptr;
+    const Implementation::Vault* vaultImpl = reinterpret_cast<const Implementation::Vault*>(vault);
+
+    uint16_t keyLength = vaultImpl->Size(key_id, true);
+    if (keyLength == 0) {
+        TRACE_L1("Key 0x%08x does not exist", key_id);
+    } else if (keyLength != 32) {
+        TRACE_L1("Unsupported ChaCha20 key size: %i bits", (keyLength * 8));
+    } else {
+        Implementation::Cipher* implementation = new Implementation::Cipher(vaultImpl, EVP_chacha20_poly1305(), key_id, static_cast<uint8_t>(keyLength), 12, 16);
+
+        if (implementation->IsValid() == true) {
+            cipher = implementation;
+        } else {
+            delete implementation;
         }
     }
 
@@ -271,4 +570,46 @@ int32_t cipher_decrypt(const struct CipherImplementation* cipher, const uint8_t
     return (cipher->Decrypt(iv_length, iv, input_length, input, max_output_length, output));
 }
 
+int32_t cipher_encrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+    const uint32_t aad_length, const uint8_t aad[],
+    const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+{
+    ASSERT(cipher != nullptr);
+    return (cipher->EncryptAEAD(iv_length, iv, aad_length, aad, input_length, input, max_output_length, output));
+}
+
+int32_t cipher_decrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+    const uint32_t aad_length, const uint8_t aad[],
+    const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+{
+    ASSERT(cipher != nullptr);
+    return (cipher->DecryptAEAD(iv_length, iv, aad_length, aad, input_length, input, max_output_length, output));
+}
+
+struct CipherStreamImplementation* cipher_stream_create(const struct CipherImplementation* cipher, const bool encrypt,
+    const uint8_t iv_length, const uint8_t iv[])
+{
+    ASSERT(cipher != nullptr);
+    return (cipher->Stream(encrypt, iv_length, iv));
+}
+
+void cipher_stream_destroy(struct CipherStreamImplementation* stream)
+{
+    ASSERT(stream != nullptr);
+    delete stream;
+}
+
+int32_t cipher_stream_update(struct CipherStreamImplementation* stream,
+    const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+{
+    ASSERT(stream != nullptr);
+    return (stream->Update(input_length, input, max_output_length, output));
+}
+
+int32_t cipher_stream_final(struct CipherStreamImplementation* stream, const uint32_t max_output_length, uint8_t output[])
+{
+    ASSERT(stream != nullptr);
+    return (stream->Final(max_output_length, output));
+}
+
 } // extern "C"
@@ -0,0 +1,85 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace Implementation {
+
+// Lock free pool of OpenSSL contexts. Acquire() hands out an idle context,
+// or nullptr if there is none, then the caller clones a new one. Release()
+// parks the context in a free slot, or destroys it if all slots are taken.
+// Slots are only ever swapped as a whole, so there is no ABA problem.
+template <typename CONTEXT, void (*DESTROY)(CONTEXT*), uint8_t SLOTS = 8>
+class ContextPool {
+public:
+    ContextPool(const ContextPool&) = delete;
+    ContextPool& operator=(const ContextPool&) = delete;
+
+    ContextPool()
+    {
+        for (uint8_t index = 0; index < SLOTS; index++) {
+            _slots[index].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ~ContextPool()
+    {
+        for (uint8_t index = 0; index < SLOTS; index++) {
+            CONTEXT* context = _slots[index].exchange(nullptr);
+
+            if (context != nullptr) {
+                DESTROY(context);
+            }
+        }
+    }
+
+public:
+    CONTEXT* Acquire()
+    {
+        CONTEXT* result = nullptr;
+
+        for (uint8_t index = 0; (index < SLOTS) && (result == nullptr); index++) {
+            if (_slots[index].load(std::memory_order_relaxed) != nullptr) {
+                result = _slots[index].exchange(nullptr, std::memory_order_acquire);
+            }
+        }
+
+        return (result);
+    }
+    void Release(CONTEXT* context)
+    {
+        bool parked = false;
+
+        for (uint8_t index = 0; (index < SLOTS) && (parked == false); index++) {
+            CONTEXT* expected = nullptr;
+            parked = _slots[index].compare_exchange_strong(expected, context, std::memory_order_release, std::memory_order_relaxed);
+        }
+
+        if (parked == false) {
+            DESTROY(context);
+        }
+    }
+
+private:
+    std::atomic<CONTEXT*> _slots[SLOTS];
+};
+
+} // namespace Implementation
@@ -34,6 +34,8 @@
 struct HashImplementation {
     virtual uint32_t Ingest(const uint32_t length, const uint8_t data[]) = 0;
     virtual uint8_t Calculate(const uint8_t maxLength, uint8_t data[]) = 0;
+    virtual void Reset() = 0;
+    virtual HashImplementation* Clone() const = 0;
 
     virtual ~HashImplementation() { }
 };
@@ -101,6 +103,14 @@ namespace Operation {
 
 } // namespace Operation
 
+// The keyed (or plain) digest context is a template, every calculation runs
+// on a copy of it. After Calculate() the digest is kept, the next Ingest()
+// starts a new calculation from the template. For HMAC the template holds the
+// keyed inner and outer state, so the key is set up only once per object.
+// An object holds one calculation at a time; the lock lets it be handed from
+// thread to thread, but threads hashing in parallel each need their own
+// object. Clone() gives them one from the same template, without touching
+// the key again.
 template<typename OPERATION>
 class HashType : public HashImplementation {
 public:
@@ -108,17 +118,10 @@ public:
     HashType<OPERATION>& operator=(const HashType) = delete;
 
     HashType(const EVP_MD* digest)
-        : _ctx(nullptr)
-        , _pkey(nullptr)
-        , _vault(nullptr)
-        , _size(0)
-        , _failure(false)
+        : HashType()
     {
         ASSERT(digest != nullptr);
 
-        _ctx = EVP_MD_CTX_create();
-        ASSERT(_ctx != nullptr);
-
         if (EVP_DigestInit_ex(_ctx, digest, NULL) == 0) {
             TRACE_L1("EVP_DigestInit_ex() failed");
             _failure = true;
@@ -159,9 +162,34 @@ public:
 
     ~HashType() override
     {
+        if (_running != nullptr) {
+            EVP_MD_CTX_destroy(_running);
+        }
         if (_ctx != nullptr) {
             EVP_MD_CTX_destroy(_ctx);
         }
+        if (_pkey != nullptr) {
+            EVP_PKEY_free(_pkey);
+        }
+
+        ::memset(_digest, 0x00, sizeof(_digest));
+    }
+
+private:
+    HashType()
+        : _lock()
+        , _ctx(EVP_MD_CTX_create())
+        , _pkey(nullptr)
+        , _vault(nullptr)
+        , _running(EVP_MD_CTX_create())
+        , _size(0)
+        , _failure(false)
+        , _error(false)
+        , _done(true)
+        , _length(0)
+    {
+        ASSERT(_ctx != nullptr);
+        ASSERT(_running != nullptr);
     }
 
 public:
@@ -169,47 +197,116 @@ public:
     {
         ASSERT(data != nullptr);
 
+        Thunder::Core::SafeSyncType<Thunder::Core::CriticalSection> lock(_lock);
+
         if (_failure == false) {
-            if (OPERATION::Update(_ctx, data, length) == 0) {
+            if (_done == true) {
+                Restart();
+            }
+
+            if ((_error == false) && (OPERATION::Update(_running, data, length) == 0)) {
                 TRACE_L1("Update() failed");
-                _failure = true;
+                _error = true;
             }
         }
 
-        return (_failure? 0 : length);
+        return (((_failure == true) || (_error == true)) ? 0 : length);
     }
 
     uint8_t Calculate(const uint8_t maxLength, uint8_t* data) override
     {
         uint8_t result = 0;
 
-        if (_failure == true) {
+        Thunder::Core::SafeSyncType<Thunder::Core::CriticalSection> lock(_lock);
+
+        if (_failure == false) {
+            if ((_done == true) && (_length == 0)) {
+                // Nothing ingested yet, calculate over no data.
+                Restart();
+            }
+        }
+
+        if ((_failure == true) || (_error == true)) {
             TRACE_L1("Hash calculation failure");
+        } else if (maxLength < _size) {
+            TRACE_L1("Output buffer to small, need %i bytes, got %i bytes", _size, maxLength);
+        } else if (_done == true) {
+            ::memcpy(data, _digest, _length);
+            result = _length;
         } else {
-            if (maxLength < _size) {
-                TRACE_L1("Output buffer to small, need %i bytes, got %i bytes", _size, maxLength);
+            size_t len = sizeof(_digest);
+            if (OPERATION::Final(_running, _digest, &len) == 0) {
+                TRACE_L1("Final() failed");
+                _error = true;
             } else {
-                size_t len = maxLength;
-                if (OPERATION::Final(_ctx, data, &len) == 0) {
-                    TRACE_L1("Final() failed");
-                    _failure = true;
-                } else {
-                    TRACE_L2("Calculated hash successfully, size: %i bytes", static_cast<uint32_t>(len));
-                    ASSERT(len == _size);
-                    result = static_cast<uint8_t>(len);
-                }
+                TRACE_L2("Calculated hash successfully, size: %i bytes", static_cast<uint32_t>(len));
+                ASSERT(len == _size);
+                _done = true;
+                _length = static_cast<uint8_t>(len);
+                ::memcpy(data, _digest, _length);
+                result = _length;
             }
         }
 
         return (result);
     }
 
+    void Reset() override
+    {
+        Thunder::Core::SafeSyncType<Thunder::Core::CriticalSection> lock(_lock);
+
+        // The next Ingest() or Calculate() restarts from the template.
+        _done = true;
+        _length = 0;
+        _error = false;
+        ::memset(_digest, 0x00, sizeof(_digest));
+    }
+
+    HashImplementation* Clone() const override
+    {
+        HashType<OPERATION>* result = nullptr;
+
+        if (_failure == false) {
+            result = new HashType<OPERATION>();
+            result->_vault = _vault;
+            result->_size = _size;
+
+            // The copied context holds its own reference to the key, the
+            // clone does not need _pkey.
+            if (EVP_MD_CTX_copy_ex(result->_ctx, _ctx) == 0) {
+                TRACE_L1("EVP_MD_CTX_copy_ex() failed");
+                delete result;
+                result = nullptr;
+            }
+        }
+
+        return (result);
+    }
+
+private:
+    void Restart()
+    {
+        _done = false;
+        _length = 0;
+        _error = (EVP_MD_CTX_copy_ex(_running, _ctx) == 0);
+
+        if (_error == true) {
+            TRACE_L1("EVP_MD_CTX_copy_ex() failed");
+        }
+    }
+
 private:
+    Thunder::Core::CriticalSection _lock;
     EVP_MD_CTX* _ctx;
     EVP_PKEY* _pkey;
     const Implementation::Vault* _vault;
+    EVP_MD_CTX* _running;
     uint16_t _size;
     bool _failure;
+    bool _error;
+    bool _done;
+    uint8_t _length;
+    uint8_t _digest[EVP_MAX_MD_SIZE];
 };
 
 } // namespace Implementation
@@ -265,4 +362,74 @@ uint8_t hash_calculate(HashImplementation* hash, const uint8_t max_length, uint8
     return (hash->Calculate(max_length, data));
 }
 
+void hash_reset(HashImplementation* hash)
+{
+    ASSERT(hash != nullptr);
+    hash->Reset();
+}
+
+HashImplementation* hash_clone(const HashImplementation* hash)
+{
+    ASSERT(hash != nullptr);
+    return (hash->Clone());
+}
+
+uint8_t hash_size(const hash_type type)
+{
+    const EVP_MD* md = Implementation::Algorithm(type);
+    return (md != nullptr ? static_cast<uint8_t>(EVP_MD_size(md)) : 0);
+}
+
+uint32_t hash_calculate_batch(const hash_type type, const uint32_t count, const uint32_t lengths[], const uint8_t* const data[],
+                              const uint32_t max_length, uint8_t digests[])
+{
+    ASSERT((count == 0) || ((lengths != nullptr) && (data != nullptr) && (digests != nullptr)));
+
+    uint32_t result = 0;
+    const EVP_MD* md = Implementation::Algorithm(type);
+
+    if (md == nullptr) {
+        TRACE_L1("Hash batch failure");
+    } else if ((static_cast<uint64_t>(count) * EVP_MD_size(md)) > max_length) {
+        TRACE_L1("Output buffer to small, need %i bytes, got %i bytes", (count * EVP_MD_size(md)), max_length);
+    } else {
+        // One context for the whole batch, re-initializing it with the same
+        // digest does not allocate. OpenSSL picks the fastest single-lane
+        // implementation the CPU supports (e.g. SHA extensions) by itself.
+        EVP_MD_CTX* ctx = EVP_MD_CTX_create();
+        ASSERT(ctx != nullptr);
+
+        const uint8_t size = static_cast<uint8_t>(EVP_MD_size(md));
+        uint8_t* digest = digests;
+
+        while ((result < count) && (ctx != nullptr)) {
+            uint32_t length = size;
+
+            ASSERT((data[result] != nullptr) || (lengths[result] == 0));
+
+            if ((EVP_DigestInit_ex(ctx, md, nullptr) == 0)
+                || (EVP_DigestUpdate(ctx, data[result], lengths[result]) == 0)
+                || (EVP_DigestFinal_ex(ctx, digest, &length) == 0)) {
+                TRACE_L1("Hash batch failed at message %i", result);
+                break;
+            }
+
+            ASSERT(length == size);
+            digest += size;
+            result++;
+        }
+
+        if (ctx != nullptr) {
+            EVP_MD_CTX_destroy(ctx);
+        }
+
+        if (result != count) {
+            ::memset(digests, 0x00, (count * size));
+            result = 0;
+        }
+    }
+
+    return (result);
+}
+
 } // extern "C"
@@ -0,0 +1,437 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../Module.h"
+
+#include <core/core.h>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PersistentStore.h"
+
+#ifndef KEYSTORE_PATH
+#define KEYSTORE_PATH "/opt/secure/cryptography"
+#endif
+
+namespace Implementation {
+
+namespace {
+
+    static constexpr uint32_t FILE_MAGIC = 0x5354434b; // "KCTS"
+    static constexpr uint16_t FILE_VERSION = 1;
+    static constexpr uint32_t RECORD_MAGIC = 0x4345524b; // "KREC"
+    static constexpr uint32_t MAX_SIZE = (64 * 1024 * 1024);
+
+    struct FileHeader {
+        uint32_t Magic;
+        uint16_t Version;
+        uint16_t Reserved;
+    };
+
+    // Followed by the locator and the sealed blob, padded to 4 bytes.
+    struct RecordHeader {
+        uint32_t Magic;
+        uint32_t Checksum;
+        uint16_t LocatorLength;
+        uint16_t BlobLength;
+        uint8_t Type;
+        uint8_t Reserved[3];
+    };
+
+    uint32_t RecordSize(const uint16_t locatorLength, const uint16_t blobLength)
+    {
+        return ((sizeof(RecordHeader) + locatorLength + blobLength + 3) & ~3u);
+    }
+
+    // FNV-1a, only meant to catch torn and partially written records.
+    uint32_t Checksum(const RecordHeader& header, const uint8_t data[])
+    {
+        uint32_t hash = 2166136261u;
+
+        auto add = [&hash](const uint8_t buffer[], const uint32_t length) {
+            for (uint32_t index = 0; index < length; index++) {
+                hash = ((hash ^ buffer[index]) * 16777619u);
+            }
+        };
+
+        add(reinterpret_cast<const uint8_t*>(&header.LocatorLength), (sizeof(RecordHeader) - offsetof(RecordHeader, LocatorLength)));
+        add(data, (header.LocatorLength + header.BlobLength));
+
+        return (hash);
+    }
+
+    // A new file only survives a power cut once its directory entry does.
+    bool SyncDirectory(const string& path)
+    {
+        const int fd = ::open(path.c_str(), (O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        const bool result = ((fd != -1) && (::fsync(fd) == 0));
+
+        if (fd != -1) {
+            ::close(fd);
+        }
+
+        return (result);
+    }
+
+} // namespace
+
+PersistentStore::PersistentStore(const string& name)
+    : _lock()
+    , _name(name)
+    , _fd(-1)
+    , _map(nullptr)
+    , _mapped(0)
+    , _size(0)
+    , _index()
+    , _dirty(false)
+{
+}
+
+PersistentStore::~PersistentStore()
+{
+    if (_dirty == true) {
+        Flush();
+    }
+    if (_map != nullptr) {
+        ::munmap(_map, _mapped);
+    }
+    if (_fd != -1) {
+        ::close(_fd);
+    }
+}
+
+// Runs with the lock taken. Opens (or creates) the file, the records are
+// indexed by Acquire().
+bool PersistentStore::Open() const
+{
+    if (_fd == -1) {
+        string directory;
+
+        if (Thunder::Core::SystemInfo::GetEnvironment(_T("CRYPTOGRAPHY_KEYSTORE"), directory) == false) {
+            directory = KEYSTORE_PATH;
+        }
+
+        const string path(directory + '/' + _name + _T(".keystore"));
+
+        int fd = ::open(path.c_str(), (O_RDWR | O_CREAT | O_CLOEXEC), (S_IRUSR | S_IWUSR));
+
+        if (fd == -1) {
+            TRACE_L1("Failed to open key store %s [%d]", path.c_str(), errno);
+        } else if (::flock(fd, LOCK_EX) != 0) {
+            TRACE_L1("Failed to lock key store %s [%d]", path.c_str(), errno);
+            ::close(fd);
+        } else {
+            // Locked, so no other process initializes or appends meanwhile.
+            struct stat info;
+            FileHeader header = { FILE_MAGIC, FILE_VERSION, 0 };
+            bool valid = false;
+
+            if (::fstat(fd, &info) != 0) {
+                TRACE_L1("Failed to stat key store %s [%d]", path.c_str(), errno);
+            } else if (info.st_size > static_cast<off_t>(MAX_SIZE)) {
+                TRACE_L1("Key store %s is larger than %d bytes", path.c_str(), MAX_SIZE);
+            } else if (info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+                if ((::ftruncate(fd, 0) != 0) || (::pwrite(fd, &header, sizeof(header), 0) != sizeof(header))
+                    || (::fsync(fd) != 0) || (SyncDirectory(directory) == false)) {
+                    TRACE_L1("Failed to initialize key store %s", path.c_str());
+                } else {
+                    valid = true;
+                }
+            } else if (::pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+                TRACE_L1("Failed to read key store %s [%d]", path.c_str(), errno);
+            } else if ((header.Magic != FILE_MAGIC) || (header.Version != FILE_VERSION)) {
+                TRACE_L1("Key store %s has an unsupported format", path.c_str());
+            } else {
+                valid = true;
+            }
+
+            ::flock(fd, LOCK_UN);
+
+            if (valid == false) {
+                ::close(fd);
+            } else {
+                _fd = fd;
+                _size = sizeof(FileHeader);
+            }
+        }
+    }
+
+    return (_fd != -1);
+}
+
+// Runs with the lock taken. Takes the file lock and indexes the records that
+// were appended (by this or another process) since the last call. A damaged
+// record followed by valid ones is skipped; damage that runs up to the end of
+// the file is a torn append and, with the exclusive lock, truncated. On
+// success the file lock is kept until Release().
+bool PersistentStore::Acquire(const bool exclusive) const
+{
+    bool result = false;
+
+    if (::flock(_fd, (exclusive ? LOCK_EX : LOCK_SH)) != 0) {
+        TRACE_L1("Failed to lock key store %s [%d]", _name.c_str(), errno);
+    } else {
+        struct stat info;
+
+        if (::fstat(_fd, &info) != 0) {
+            TRACE_L1("Failed to stat key store %s [%d]", _name.c_str(), errno);
+        } else if (info.st_size > static_cast<off_t>(MAX_SIZE)) {
+            TRACE_L1("Key store %s is larger than %d bytes", _name.c_str(), MAX_SIZE);
+        } else if (info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            TRACE_L1("Key store %s lost its header", _name.c_str());
+        } else {
+            const uint32_t size = static_cast<uint32_t>(info.st_size);
+
+            if (size < _size) {
+                // Cut short outside of the key store, the index can not be trusted anymore.
+                TRACE_L1("Key store %s shrunk, indexing it again", _name.c_str());
+                _index.clear();
+                _size = sizeof(FileHeader);
+            }
+
+            // Also covers records this process appended since the last call.
+            if (Map(size) == true) {
+                uint32_t offset = _size;
+
+                while ((offset + sizeof(RecordHeader)) <= size) {
+                    uint32_t length = Record(offset, size);
+
+                    if (length == 0) {
+                        // Records are 4 byte aligned, look for the next valid one.
+                        uint32_t next = (offset + 4);
+
+                        while (((next + sizeof(RecordHeader)) <= size) && (Record(next, size) == 0)) {
+                            next += 4;
+                        }
+
+                        if ((next + sizeof(RecordHeader)) > size) {
+                            break;
+                        }
+
+                        TRACE_L1("Skipping %d bytes of damaged records in key store %s", (next - offset), _name.c_str());
+                        offset = next;
+                        length = Record(offset, size);
+                    }
+
+                    const RecordHeader* record = reinterpret_cast<const RecordHeader*>(_map + offset);
+                    _index[string(reinterpret_cast<const char*>(record + 1), record->LocatorLength)] = offset;
+                    offset += length;
+                }
+
+                if ((offset < size) && (exclusive == true)) {
+                    TRACE_L1("Dropping %d bytes of incomplete records from key store %s", (size - offset), _name.c_str());
+                    if (::ftruncate(_fd, offset) != 0) {
+                        TRACE_L1("Failed to truncate key store %s [%d]", _name.c_str(), errno);
+                    }
+                }
+
+                if (offset > _size) {
+                    TRACE_L2("Indexed key store %s up to %d bytes, %d keys", _name.c_str(), offset, static_cast<uint32_t>(_index.size()));
+                    _size = offset;
+                }
+
+                result = true;
+            }
+        }
+
+        if (result == false) {
+            ::flock(_fd, LOCK_UN);
+        }
+    }
+
+    return (result);
+}
+
+void PersistentStore::Release() const
+{
+    ::flock(_fd, LOCK_UN);
+}
+
+// Runs with the lock taken. Returns the size of the valid record at offset,
+// or 0 if there is none.
+uint32_t PersistentStore::Record(const uint32_t offset, const uint32_t size) const
+{
+    uint32_t result = 0;
+
+    const RecordHeader* record = reinterpret_cast<const RecordHeader*>(_map + offset);
+
+    if (record->Magic == RECORD_MAGIC) {
+        const uint32_t length = RecordSize(record->LocatorLength, record->BlobLength);
+
+        if (((offset + length) <= size) && (record->Checksum == Checksum(*record, reinterpret_cast<const uint8_t*>(record + 1)))) {
+            result = length;
+        }
+    }
+
+    return (result);
+}
+
+// Runs with the lock taken. (Re)maps the file if records were appended
+// beyond the current mapping.
+bool PersistentStore::Map(const uint32_t size) const
+{
+    if (size > _mapped) {
+        if (_map != nullptr) {
+            ::munmap(_map, _mapped);
+            _map = nullptr;
+            _mapped = 0;
+        }
+
+        void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, _fd, 0);
+
+        if (map == MAP_FAILED) {
+            TRACE_L1("Failed to map key store %s [%d]", _name.c_str(), errno);
+        } else {
+            _map = static_cast<uint8_t*>(map);
+            _mapped = size;
+        }
+    }
+
+    return (_map != nullptr);
+}
+
+uint32_t PersistentStore::Exists(const string& locator, bool& result) const
+{
+    uint32_t error = Thunder::Core::ERROR_UNAVAILABLE;
+
+    _lock.Lock();
+
+    if ((Open() == true) && (Acquire(false) == true)) {
+        result = (_index.find(locator) != _index.end());
+        error = Thunder::Core::ERROR_NONE;
+
+        Release();
+    }
+
+    _lock.Unlock();
+
+    return (error);
+}
+
+uint32_t PersistentStore::Load(const string& locator, uint8_t& type, const uint16_t maxLength, uint8_t blob[], uint16_t& length) const
+{
+    uint32_t error = Thunder::Core::ERROR_UNAVAILABLE;
+
+    _lock.Lock();
+
+    if ((Open() == true) && (Acquire(false) == true)) {
+        auto entry = _index.find(locator);
+
+        if (entry == _index.end()) {
+            error = Thunder::Core::ERROR_UNKNOWN_KEY;
+        } else {
+            const RecordHeader* record = reinterpret_cast<const RecordHeader*>(_map + entry->second);
+
+            if (record->BlobLength > maxLength) {
+                error = Thunder::Core::ERROR_GENERAL;
+            } else {
+                type = record->Type;
+                length = record->BlobLength;
+                ::memcpy(blob, (reinterpret_cast<const uint8_t*>(record + 1) + record->LocatorLength), length);
+                error = Thunder::Core::ERROR_NONE;
+            }
+        }
+
+        Release();
+    }
+
+    _lock.Unlock();
+
+    return (error);
+}
+
+uint32_t PersistentStore::Append(const string& locator, const uint8_t type, const uint16_t length, const uint8_t blob[])
+{
+    uint32_t error = Thunder::Core::ERROR_UNAVAILABLE;
+
+    ASSERT(locator.empty() == false);
+    ASSERT(locator.length() <= USHRT_MAX);
+
+    _lock.Lock();
+
+    // Exclusive, so the record goes after whatever other processes appended.
+    if ((Open() == true) && (Acquire(true) == true)) {
+        const uint32_t size = RecordSize(static_cast<uint16_t>(locator.length()), length);
+
+        if ((_size + size) > MAX_SIZE) {
+            TRACE_L1("Key store %s is full", _name.c_str());
+            error = Thunder::Core::ERROR_GENERAL;
+        } else {
+            uint8_t* buffer = static_cast<uint8_t*>(ALLOCA(size));
+            RecordHeader* record = reinterpret_cast<RecordHeader*>(buffer);
+
+            ::memset(buffer, 0, size);
+            record->Magic = RECORD_MAGIC;
+            record->LocatorLength = static_cast<uint16_t>(locator.length());
+            record->BlobLength = length;
+            record->Type = type;
+            ::memcpy(buffer + sizeof(RecordHeader), locator.data(), locator.length());
+            ::memcpy(buffer + sizeof(RecordHeader) + locator.length(), blob, length);
+            record->Checksum = Checksum(*record, (buffer + sizeof(RecordHeader)));
+
+            if (::pwrite(_fd, buffer, size, _size) != static_cast<ssize_t>(size)) {
+                TRACE_L1("Failed to append to key store %s [%d]", _name.c_str(), errno);
+                VARIABLE_IS_NOT_USED int result = ::ftruncate(_fd, _size);
+                error = Thunder::Core::ERROR_GENERAL;
+            } else {
+                _index[locator] = _size;
+                _size += size;
+                _dirty = true;
+                error = Thunder::Core::ERROR_NONE;
+            }
+
+            ::memset(buffer, 0, size);
+        }
+
+        Release();
+    }
+
+    _lock.Unlock();
+
+    return (error);
+}
+
+uint32_t PersistentStore::Flush()
+{
+    uint32_t error = Thunder::Core::ERROR_NONE;
+
+    _lock.Lock();
+
+    // One sync for everything appended since the previous flush.
+    if ((_dirty == true) && (_fd != -1)) {
+        if (::fdatasync(_fd) != 0) {
+            TRACE_L1("Failed to sync key store %s [%d]", _name.c_str(), errno);
+            error = Thunder::Core::ERROR_GENERAL;
+        } else {
+            _dirty = false;
+        }
+    }
+
+    _lock.Unlock();
+
+    return (error);
+}
+
+} // namespace Implementation
@@ -0,0 +1,69 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../Module.h"
+#include <unordered_map>
+
+namespace Implementation {
+
+// Append-only store of sealed key blobs, one file per vault. The file is
+// memory mapped and indexed by locator, so loading a key is a hash lookup
+// in the mapping. A record that is added later for the same locator
+// replaces the earlier one. Appends are not synced, Flush() syncs all of
+// them at once. The file can be shared by several processes: it is locked
+// while it is read or appended to, and records appended by others are
+// indexed first. A torn record at the end of the file (e.g. after a power
+// cut before the flush) is dropped by the next append, a damaged record
+// in between valid ones is skipped.
+class PersistentStore {
+public:
+    PersistentStore() = delete;
+    PersistentStore(const PersistentStore&) = delete;
+    PersistentStore& operator=(const PersistentStore&) = delete;
+
+    PersistentStore(const string& name);
+    ~PersistentStore();
+
+public:
+    uint32_t Exists(const string& locator, bool& result) const;
+    uint32_t Load(const string& locator, uint8_t& type, const uint16_t maxLength, uint8_t blob[], uint16_t& length) const;
+    uint32_t Append(const string& locator, const uint8_t type, const uint16_t length, const uint8_t blob[]);
+    uint32_t Flush();
+
+private:
+    bool Open() const;
+    bool Acquire(const bool exclusive) const;
+    void Release() const;
+    uint32_t Record(const uint32_t offset, const uint32_t size) const;
+    bool Map(const uint32_t size) const;
+
+private:
+    mutable Thunder::Core::CriticalSection _lock;
+    string _name;
+    mutable int _fd;
+    mutable uint8_t* _map;
+    mutable uint32_t _mapped;
+    mutable uint32_t _size;
+    mutable std::unordered_map<string, uint32_t> _index;
+    bool _dirty;
+};
+
+} // namespace Implementation
@@ -19,15 +19,264 @@
 
 #include "../../Module.h"
 #include "../random_implementation.h"
+
+#include <core/core.h>
+
+#include <atomic>
+#include <mutex>
+
+#include <pthread.h>
+
+#include <openssl/evp.h>
 #include <openssl/rand.h>
 
+#ifndef RANDOM_RESEED_INTERVAL
+#define RANDOM_RESEED_INTERVAL 1024
+#endif
+
 namespace Implementation {
 
+namespace {
+
+    // Bumped in the child after a fork, so no thread state of the parent is
+    // used to hand out the same bytes twice.
+    std::atomic<uint32_t> forkGeneration(0);
+
+    void Forked()
+    {
+        forkGeneration++;
+    }
+
+    // Generate requests between reseeds, 0 turns the DRBG off and every
+    // request goes to OpenSSL.
+    uint32_t ReseedInterval()
+    {
+        static uint32_t interval = RANDOM_RESEED_INTERVAL;
+        static std::once_flag once;
+
+        std::call_once(once, []() {
+            string value;
+
+            if (Thunder::Core::SystemInfo::GetEnvironment(_T("CRYPTOGRAPHY_RANDOM_RESEED"), value) == true) {
+                interval = static_cast<uint32_t>(::strtoul(value.c_str(), nullptr, 10));
+            }
+
+            VARIABLE_IS_NOT_USED int result = pthread_atfork(nullptr, nullptr, Forked);
+            ASSERT(result == 0);
+        });
+
+        return (interval);
+    }
+
+} // namespace
+
+// CTR_DRBG with AES-256 and no derivation function (NIST SP 800-90A),
+// seeded and reseeded from the OpenSSL DRBG. Incrementing V for every
+// block is AES-256-CTR over zeros with V + 1 as the counter block, so a
+// generate request is a single EVP call. Every thread has its own, small
+// requests are served from a buffer of output that is wiped as it is
+// handed out.
+class DRBG {
+private:
+    static constexpr uint8_t KeyLength = 32;
+    static constexpr uint8_t BlockLength = 16;
+    static constexpr uint8_t SeedLength = (KeyLength + BlockLength);
+    static constexpr uint16_t BufferSize = 1024;
+    static constexpr uint32_t MaxRequest = (64 * 1024); // 2^19 bits
+
+public:
+    DRBG(const DRBG&) = delete;
+    DRBG& operator=(const DRBG&) = delete;
+
+    DRBG()
+        : _context(EVP_CIPHER_CTX_new())
+        , _generation(~0u)
+        , _counter(0)
+        , _available(0)
+    {
+        ASSERT(_context != nullptr);
+        ::memset(_key, 0x00, sizeof(_key));
+        ::memset(_v, 0x00, sizeof(_v));
+    }
+    ~DRBG()
+    {
+        Wipe();
+
+        if (_context != nullptr) {
+            EVP_CIPHER_CTX_free(_context);
+        }
+    }
+
+public:
+    uint16_t Generate(const uint16_t length, uint8_t data[])
+    {
+        uint16_t result = 0;
+
+        if (_generation != forkGeneration.load()) {
+            Wipe();
+            _generation = forkGeneration.load();
+        }
+
+        if (length <= (BufferSize / 4)) {
+            if ((_available < length) && (Refill() == false)) {
+                Wipe();
+            } else {
+                uint8_t* source = &_buffer[BufferSize - _available];
+                ::memcpy(data, source, length);
+                ::memset(source, 0x00, length);
+                _available -= length;
+                result = length;
+            }
+        } else if (Output(length, data) == true) {
+            result = length;
+        } else {
+            Wipe();
+        }
+
+        return (result);
+    }
+
+private:
+    bool Refill()
+    {
+        // The leftover is dropped, not worth keeping for a few bytes.
+        ::memset(_buffer, 0x00, sizeof(_buffer));
+        _available = 0;
+
+        if (Output(sizeof(_buffer), _buffer) == true) {
+            _available = sizeof(_buffer);
+        }
+
+        return (_available != 0);
+    }
+
+    bool Output(const uint32_t length, uint8_t data[])
+    {
+        bool result = true;
+        uint32_t offset = 0;
+
+        while ((offset < length) && (result == true)) {
+            const uint32_t size = ((length - offset) > MaxRequest ? MaxRequest : (length - offset));
+
+            if ((_counter == 0) || (_counter > ReseedInterval())) {
+                result = Reseed();
+            }
+
+            if (result == true) {
+                ::memset(data + offset, 0x00, size);
+                result = (Keystream(size, data + offset) && Update(nullptr));
+                _counter++;
+                offset += size;
+            }
+        }
+
+        return (result);
+    }
+
+    bool Reseed()
+    {
+        uint8_t seed[SeedLength];
+        bool result = (RAND_priv_bytes(seed, sizeof(seed)) == 1);
+
+        if (result == false) {
+            TRACE_L1("Failed to get entropy for the DRBG");
+        } else {
+            // A first seed starts from a zero key and V.
+            result = Update(seed);
+            _counter = 1;
+        }
+
+        ::memset(seed, 0x00, sizeof(seed));
+
+        return (result);
+    }
+
+    // The CTR_DRBG update function, provided is SeedLength bytes or none.
+    bool Update(const uint8_t provided[])
+    {
+        uint8_t temp[SeedLength];
+
+        ::memset(temp, 0x00, sizeof(temp));
+
+        bool result = Keystream(sizeof(temp), temp);
+
+        if (result == true) {
+            if (provided != nullptr) {
+                for (uint8_t index = 0; index < SeedLength; index++) {
+                    temp[index] ^= provided[index];
+                }
+            }
+
+            ::memcpy(_key, temp, KeyLength);
+            ::memcpy(_v, temp + KeyLength, BlockLength);
+        }
+
+        ::memset(temp, 0x00, sizeof(temp));
+
+        return (result);
+    }
+
+    // XORs the AES-256 output for V + 1, V + 2, ... into data and advances V.
+    bool Keystream(const uint32_t length, uint8_t data[])
+    {
+        bool result = false;
+        uint8_t counter[BlockLength];
+        int size = 0;
+
+        ::memcpy(counter, _v, sizeof(counter));
+        Increment(counter, 1);
+
+        if ((EVP_EncryptInit_ex(_context, EVP_aes_256_ctr(), nullptr, _key, counter) == 1)
+            && (EVP_EncryptUpdate(_context, data, &size, data, static_cast<int>(length)) == 1)) {
+            ASSERT(static_cast<uint32_t>(size) == length);
+            Increment(_v, ((length + BlockLength - 1) / BlockLength));
+            result = true;
+        } else {
+            TRACE_L1("DRBG keystream failed");
+        }
+
+        ::memset(counter, 0x00, sizeof(counter));
+
+        return (result);
+    }
+
+    static void Increment(uint8_t block[], uint32_t value)
+    {
+        for (uint8_t index = BlockLength; (index > 0) && (value != 0); index--) {
+            value += block[index - 1];
+            block[index - 1] = static_cast<uint8_t>(value);
+            value >>= 8;
+        }
+    }
+
+    void Wipe()
+    {
+        ::memset(_key, 0x00, sizeof(_key));
+        ::memset(_v, 0x00, sizeof(_v));
+        ::memset(_buffer, 0x00, sizeof(_buffer));
+        _available = 0;
+        _counter = 0;
+    }
+
+private:
+    EVP_CIPHER_CTX* _context;
+    uint32_t _generation;
+    uint32_t _counter;
+    uint16_t _available;
+    uint8_t _key[KeyLength];
+    uint8_t _v[BlockLength];
+    uint8_t _buffer[BufferSize];
+};
+
 static uint16_t Generate(const uint16_t length, uint8_t data[])
 {
     uint16_t result = 0;
 
-    if (RAND_bytes(data, length) == 1) {
+    if (ReseedInterval() != 0) {
+        static thread_local DRBG drbg;
+
+        result = drbg.Generate(length, data);
+    } else if (RAND_bytes(data, length) == 1) {
         result = length;
     }
 
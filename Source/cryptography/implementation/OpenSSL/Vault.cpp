@@ -207,7 +207,7 @@ POP_WARNING()
         vault.Delete(Netflix::KPE_ID);
     };
 
-    static Vault instance(string(reinterpret_cast<const char*>(key), sizeof(key)), ctor, dtor);
+    static Vault instance(string(reinterpret_cast<const char*>(key), sizeof(key)), _T("netflix"), ctor, dtor);
     return (instance);
 }
 
@@ -215,15 +215,15 @@ POP_WARNING()
 {
     static const uint8_t key[] = { 0x42, 0x71, 0x7b, 0x85, 0x98, 0x61, 0xe3, 0x19, 0x16, 0xd1, 0xc7, 0x28, 0x02, 0x9a, 0xc4, 0x07 };
 
-    static Vault instance(string(reinterpret_cast<const char*>(key), sizeof(key)));
+    static Vault instance(string(reinterpret_cast<const char*>(key), sizeof(key)), _T("platform"));
     return (instance);
 }
 
-Vault::Vault(const string key, const Callback& ctor, const Callback& dtor)
-    : _lock()
-    , _items()
+Vault::Vault(const string key, const string& store, const Callback& ctor, const Callback& dtor)
+    : _items()
     , _lastHandle(0)
     , _vaultKey(key)
+    , _store(store)
     , _dtor(dtor)
 {
     if (ctor != nullptr) {
@@ -240,6 +240,19 @@ Vault::~Vault()
     }
 }
 
+uint32_t Vault::Insert(Element* element)
+{
+    // While the constructor runs the ids are well known and handed out in
+    // sequence, from then on the handle table picks them.
+    const uint32_t id = (_lastHandle < 0x80000000 ? _items.Insert(element, static_cast<uint16_t>(_lastHandle + 1)) : _items.Insert(element));
+
+    if ((id != 0) && (_lastHandle < 0x80000000)) {
+        _lastHandle = id;
+    }
+
+    return (id);
+}
+
 uint16_t Vault::Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[], const uint16_t maxOutSize, uint8_t output[]) const
 {
     uint16_t result = 0;
@@ -288,11 +301,7 @@ uint16_t Vault::Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[
             }
         }
 
-#if OPENSSL_VERSION_NUMBER >= 0x10100000L
-        EVP_CIPHER_CTX_reset(ctx);
-#else
-        EVP_CIPHER_CTX_cleanup(ctx);
-#endif
+        EVP_CIPHER_CTX_free(ctx);
     }
 
     return (result);
@@ -302,13 +311,12 @@ uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
 {
     uint16_t size = 0;
 
-    _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        if ((allowSealed == true) || (*it).second.IsExportable() == true) {
-            size = ((*it).second.Size() - IV_SIZE);
+    HandleTable<Element>::Reference element(_items, id);
+    if (element.IsValid() == true) {
+        if ((allowSealed == true) || element->IsExportable() == true) {
+            size = (element->Size() - IV_SIZE);
             TRACE_L2("%sBlob id 0x%08x size: %i",
-                (((allowSealed == true) || ((*it).second.IsExportable() == false)) ? "Internal: " : ""), id, size);
+                (((allowSealed == true) || (element->IsExportable() == false)) ? "Internal: " : ""), id, size);
         } else {
             TRACE_L2("Blob id 0x%08x is sealed, won't tell its size", id);
             size = USHRT_MAX;
@@ -316,7 +324,6 @@ uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
     } else {
         TRACE_L1("Failed to look up blob id 0x%08x", id);
     }
-    _lock.Unlock();
 
     return (size);
 }
@@ -326,22 +333,16 @@ uint32_t Vault::Import(const uint16_t size, const uint8_t blob[], bool exportabl
     uint32_t id = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
-
-        if (id != 0) {
-            uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
-            uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
-
-            _items.emplace(std::piecewise_construct,
-                std::forward_as_tuple(id),
-                std::forward_as_tuple(exportable, len, buf));
+        uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
+        uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
 
-            _lastHandle = id;
+        id = Insert(new Element(exportable, len, buf));
 
+        if (id != 0) {
             TRACE_L2("Added a %s data blob of size %i as id 0x%08x", (exportable ? "clear" : "sealed"), (len - IV_SIZE), id);
+        } else {
+            TRACE_L1("Failed to add a data blob, the vault is full");
         }
-        _lock.Unlock();
     }
 
     return (id);
@@ -352,21 +353,19 @@ uint16_t Vault::Export(const uint32_t id, const uint16_t size, uint8_t blob[], b
     uint16_t outSize = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            if ((allowSealed == true) || ((*it).second.IsExportable() == true)) {
-                outSize = Cipher(false, (*it).second.Size(), (*it).second.Buffer(), size, blob);
+        HandleTable<Element>::Reference element(_items, id);
+        if (element.IsValid() == true) {
+            if ((allowSealed == true) || (element->IsExportable() == true)) {
+                outSize = Cipher(false, element->Size(), element->Buffer(), size, blob);
 
                 TRACE_L2("%sExported %i bytes from blob id 0x%08x",
-                    (((allowSealed == true) || ((*it).second.IsExportable() == false)) ? "Internal: " : ""), outSize, id);
+                    (((allowSealed == true) || (element->IsExportable() == false)) ? "Internal: " : ""), outSize, id);
             } else {
                 TRACE_L1("Blob id 0x%08x is sealed, can't export", id);
             }
         } else {
             TRACE_L1("Failed to look up blob id 0x%08x", id);
         }
-        _lock.Unlock();
     }
 
     return (outSize);
@@ -377,18 +376,13 @@ uint32_t Vault::Put(const uint16_t size, const uint8_t blob[])
     uint32_t id = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
-        if (id != 0) {
-            _items.emplace(std::piecewise_construct,
-                std::forward_as_tuple(id),
-                std::forward_as_tuple(false, size, blob));
-
-            _lastHandle = id;
+        id = Insert(new Element(false, size, blob));
 
+        if (id != 0) {
             TRACE_L2("Inserted a sealed data blob of size %i as id 0x%08x", size, id);
+        } else {
+            TRACE_L1("Failed to insert a data blob, the vault is full");
         }
-        _lock.Unlock();
     }
 
     return (id);
@@ -399,14 +393,12 @@ uint16_t Vault::Get(const uint32_t id, const uint16_t size, uint8_t blob[]) cons
     uint16_t result = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            result = std::min(size, static_cast<uint16_t>((*it).second.Size()));
-            ::memcpy(blob, (*it).second.Buffer(), result);
+        HandleTable<Element>::Reference element(_items, id);
+        if (element.IsValid() == true) {
+            result = std::min(size, static_cast<uint16_t>(element->Size()));
+            ::memcpy(blob, element->Buffer(), result);
             TRACE_L2("Retrieved a sealed data blob id 0x%08x of size %i bytes", id, result);
         }
-        _lock.Unlock();
     }
 
     return (result);
@@ -436,19 +428,93 @@ uint32_t Vault::Generate(const uint16_t size)
 
 bool Vault::Delete(const uint32_t id)
 {
-    bool result = false;
+    return (_items.Remove(id));
+}
+
+uint32_t Vault::Exists(const string& locator, bool& result) const
+{
+    return (_store.Exists(locator, result));
+}
+
+// The key store holds the keys as they are kept in the vault, i.e. sealed
+// with the vault key, so a load puts the blob back as is.
+uint32_t Vault::Load(const string& locator, uint32_t& id)
+{
+    uint8_t type = 0;
+    uint16_t length = 0;
+    uint8_t* blob = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
+
+    uint32_t result = _store.Load(locator, type, USHRT_MAX, blob, length);
+
+    if (result == Thunder::Core::ERROR_NONE) {
+        id = Put(length, blob);
+
+        if (id == 0) {
+            result = Thunder::Core::ERROR_GENERAL;
+        } else {
+            TRACE_L2("Loaded persistent key '%s' as id 0x%08x", locator.c_str(), id);
+        }
+    }
+
+    ::memset(blob, 0x00, length);
+
+    return (result);
+}
+
+uint32_t Vault::Create(const string& locator, const key_type keyType, uint32_t& id)
+{
+    uint32_t result = Thunder::Core::ERROR_NONE;
+    uint16_t length = 0;
 
-    _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        _items.erase(it);
-        result = true;
+    switch (keyType) {
+    case key_type::AES128:
+    case key_type::HMAC128:
+        length = 16;
+        break;
+    case key_type::HMAC160:
+        length = 20;
+        break;
+    case key_type::AES256:
+    case key_type::HMAC256:
+        length = 32;
+        break;
+    default:
+        TRACE_L1("Unsupported key type %i", keyType);
+        result = Thunder::Core::ERROR_GENERAL;
+        break;
+    }
+
+    if (result == Thunder::Core::ERROR_NONE) {
+        // Persistent keys are never exportable.
+        id = Generate(length);
+
+        if (id == 0) {
+            result = Thunder::Core::ERROR_GENERAL;
+        } else {
+            uint8_t* blob = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
+            const uint16_t sealed = Get(id, USHRT_MAX, blob);
+
+            result = _store.Append(locator, static_cast<uint8_t>(keyType), sealed, blob);
+
+            if (result != Thunder::Core::ERROR_NONE) {
+                Delete(id);
+                id = 0;
+            } else {
+                TRACE_L2("Created persistent key '%s' as id 0x%08x", locator.c_str(), id);
+            }
+
+            ::memset(blob, 0x00, sealed);
+        }
     }
-    _lock.Unlock();
 
     return (result);
 }
 
+uint32_t Vault::Flush()
+{
+    return (_store.Flush());
+}
+
 } // namespace Implementation
 
 extern "C" {
@@ -549,24 +615,38 @@ uint32_t netflix_security_wrapping_key(void)
     return (Implementation::Vault::NetflixInstance().Size(Implementation::Netflix::KPW_ID) != 0 ? Implementation::Netflix::KPW_ID : 0);
 }
 
-uint32_t persistent_key_exists(struct VaultImplementation* /* vault */, const char* /* locator[] */, bool* /* result */)
+uint32_t persistent_key_exists(struct VaultImplementation* vault, const char locator[], bool* result)
 {
-    return (Thunder::Core::ERROR_UNAVAILABLE);
+    ASSERT(vault != nullptr);
+    ASSERT(locator != nullptr);
+    ASSERT(result != nullptr);
+    const Implementation::Vault* vaultImpl = reinterpret_cast<const Implementation::Vault*>(vault);
+    return (vaultImpl->Exists(locator, *result));
 }
 
-uint32_t persistent_key_load(struct VaultImplementation* /* vault */, const char* /* locator[] */, uint32_t* /* id */)
+uint32_t persistent_key_load(struct VaultImplementation* vault, const char locator[], uint32_t* id)
 {
-    return (Thunder::Core::ERROR_UNAVAILABLE);
+    ASSERT(vault != nullptr);
+    ASSERT(locator != nullptr);
+    ASSERT(id != nullptr);
+    Implementation::Vault* vaultImpl = reinterpret_cast<Implementation::Vault*>(vault);
+    return (vaultImpl->Load(locator, *id));
 }
 
-uint32_t persistent_key_create(struct VaultImplementation* /* vault */, const char* /* locator[] */, const key_type /* keyType */, uint32_t* /* id */)
+uint32_t persistent_key_create(struct VaultImplementation* vault, const char locator[], const key_type keyType, uint32_t* id)
 {
-    return (Thunder::Core::ERROR_UNAVAILABLE);
+    ASSERT(vault != nullptr);
+    ASSERT(locator != nullptr);
+    ASSERT(id != nullptr);
+    Implementation::Vault* vaultImpl = reinterpret_cast<Implementation::Vault*>(vault);
+    return (vaultImpl->Create(locator, keyType, *id));
 }
 
-uint32_t persistent_flush(struct VaultImplementation* /* vault */)
+uint32_t persistent_flush(struct VaultImplementation* vault)
 {
-    return (Thunder::Core::ERROR_UNAVAILABLE);
+    ASSERT(vault != nullptr);
+    Implementation::Vault* vaultImpl = reinterpret_cast<Implementation::Vault*>(vault);
+    return (vaultImpl->Flush());
 }
 
 } // extern "C"
@@ -18,7 +18,9 @@
  */
 
 #include "../../Module.h"
-#include <map>
+#include "../HandleTable.h"
+#include "PersistentStore.h"
+#include <persistent_implementation.h>
 #include <climits>
 
 
@@ -32,7 +34,7 @@ public:
 private:
     using Callback = std::function<void(Vault&)>;
 
-    Vault(const string key, const Callback& ctor = nullptr, const Callback& dtor = nullptr);
+    Vault(const string key, const string& store, const Callback& ctor = nullptr, const Callback& dtor = nullptr);
     ~Vault();
 
 public:
@@ -73,14 +75,22 @@ public:
     uint32_t Generate(const uint16_t length);
     bool Delete(const uint32_t id);
 
+    uint32_t Exists(const string& locator, bool& result) const;
+    uint32_t Load(const string& locator, uint32_t& id);
+    uint32_t Create(const string& locator, const key_type keyType, uint32_t& id);
+    uint32_t Flush();
+
 private:
     uint16_t Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[], const uint16_t maxOutSize, uint8_t output[]) const;
 
 private:
-    mutable Thunder::Core::CriticalSection _lock;
-    std::map<uint32_t, Element> _items;
+    uint32_t Insert(Element* element);
+
+private:
+    HandleTable<Element> _items;
     uint32_t _lastHandle;
     string _vaultKey;
+    PersistentStore _store;
     Callback _dtor;
 };
 
@@ -51,6 +51,158 @@ namespace Implementation {
 
     }
 
+    /*********************************************************************
+     * @function Function Stream
+     *
+     * @brief   brief Starts a chunked encryption/decryption, the cipher
+     *          handle carries the chaining state between the chunks
+     *
+     * @param[in] encrypt - mode :true for enc and false for decrypt
+     * @param[in] ivLength - Length of the iv value
+     * @param[in] iv - intitialization vector
+     *
+     * @return The stream, nullptr on failure
+     *
+     *********************************************************************/
+    CipherStreamImplementation* Cipher::Stream(const bool encrypt, const uint8_t ivLength, const uint8_t iv[]) const
+    {
+        CipherStreamImplementation* result = nullptr;
+        ASSERT(iv != nullptr);
+
+        if (ivLength != _ivLength) {
+            TRACE_L1(_T("SEC: Invalid IV length! [%i]"), ivLength);
+        }
+        else if (_vault->getSecProcHandle() == nullptr) {
+            TRACE_L1(_T("SEC: Unable to have a valid secproc handle from vault \n"));
+        }
+        else {
+            IdStore* ids;
+            uint8_t* keyBuf = reinterpret_cast<uint8_t*>(ALLOCA(sizeof(ids)));
+            ASSERT(keyBuf != nullptr);
+
+            uint16_t length = _vault->Export(_keyId, _keyLength, keyBuf, true);
+            if (length != _keyLength) {
+                TRACE_L1(_T("SEC: Failed to retrieve a valid encryption key from id 0x%08x"), _keyId);
+            }
+            else {
+                Sec_KeyHandle* sec_key = nullptr;
+                std::memcpy(&ids, keyBuf, sizeof(ids));
+                ASSERT(ids->idAes != 0);
+
+                Sec_Result sec_result = SecKey_GetInstance(_vault->getSecProcHandle(), ids->idAes, &sec_key);
+                if (sec_key == nullptr || sec_result != SEC_RESULT_SUCCESS) {
+                    TRACE_L1(_T("SEC: Key instance failed ,retVal = %d \n"), sec_result);
+                }
+                else {
+                    Sec_CipherHandle* cipher_handle = NULL;
+                    SEC_BYTE* iv_data = const_cast<SEC_BYTE*>(iv);
+                    sec_result = SecCipher_GetInstance(_vault->getSecProcHandle(), _algorithm, (encrypt ? SEC_CIPHERMODE_ENCRYPT : SEC_CIPHERMODE_DECRYPT),
+                        sec_key, iv_data, &cipher_handle);
+                    if (sec_result != SEC_RESULT_SUCCESS || cipher_handle == NULL) {
+                        TRACE_L1(_T("SEC:cipher handle not created retVal = %d and cipher handle =%p \n"), sec_result, cipher_handle);
+                        SecKey_Release(sec_key);
+                    }
+                    else {
+                        result = new CipherStream(sec_key, cipher_handle);
+                    }
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    /* COTR */
+    CipherStream::CipherStream(Sec_KeyHandle* key, Sec_CipherHandle* cipher)
+        : _key(key)
+        , _cipher(cipher)
+        , _finished(false)
+    {
+        ASSERT(key != nullptr);
+        ASSERT(cipher != nullptr);
+    }
+
+    /* DOTR */
+    CipherStream::~CipherStream()
+    {
+        SecCipher_Release(_cipher);
+        SecKey_Release(_key);
+    }
+
+    /*********************************************************************
+     * @function Function Update
+     *
+     * @brief   brief Processes the next chunk of the stream
+     *
+     * @param[in] inputLength - Length of input chunk
+     * @param[in] input - input chunk
+     * @param[in] maxOutputLength - max possible length of output buffer
+     * @param[out] output - processed output
+     *
+     * @return Length of the bytesWritten
+     *
+     *********************************************************************/
+    int32_t CipherStream::Update(const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[])
+    {
+        SEC_SIZE OutputLength = 0;
+        ASSERT(input != nullptr);
+
+        if (_finished == true) {
+            TRACE_L1(_T("SEC: Stream is already finished"));
+        }
+        else if (maxOutputLength < (inputLength + 16)) {
+            TRACE_L1(_T("Too small output buffer, expected: %i bytes"), (inputLength + 16));
+            return (-static_cast<int32_t>(inputLength + 16));
+        }
+        else {
+            SEC_BYTE* input_data = const_cast<SEC_BYTE*>(input);
+            Sec_Result sec_res = SecCipher_Process(_cipher, input_data, inputLength, SEC_FALSE, output, maxOutputLength, &OutputLength);
+            if (sec_res != SEC_RESULT_SUCCESS) {
+                TRACE_L1(_T("SEC SecCipher_Process failed retVal = %d \n"), sec_res);
+                OutputLength = 0;
+                _finished = true;
+            }
+        }
+
+        return (OutputLength);
+    }
+
+    /*********************************************************************
+     * @function Function Final
+     *
+     * @brief   brief Processes the last (padded) block of the stream
+     *
+     * @param[in] maxOutputLength - max possible length of output buffer
+     * @param[out] output - processed output
+     *
+     * @return Length of the bytesWritten
+     *
+     *********************************************************************/
+    int32_t CipherStream::Final(const uint32_t maxOutputLength, uint8_t output[])
+    {
+        SEC_SIZE OutputLength = 0;
+
+        if (_finished == true) {
+            TRACE_L1(_T("SEC: Stream is already finished"));
+        }
+        else if (maxOutputLength < 16) {
+            TRACE_L1(_T("Too small output buffer, expected: %i bytes"), 16);
+            return (-16);
+        }
+        else {
+            SEC_BYTE last[1] = { 0 };
+            _finished = true;
+            Sec_Result sec_res = SecCipher_Process(_cipher, last, 0, SEC_TRUE, output, maxOutputLength, &OutputLength);
+            if (sec_res != SEC_RESULT_SUCCESS) {
+                TRACE_L1(_T("SEC SecCipher_Process failed retVal = %d \n"), sec_res);
+                OutputLength = 0;
+            }
+        }
+
+        return (OutputLength);
+    }
+
     /*********************************************************************
      * @function Function Encrypt
      *
@@ -226,6 +378,9 @@ namespace Implementation {
         case aes_mode::AES_MODE_CFB128:
             TRACE_L1(_T("Unsupported AES cipher block mode"));
             break;
+        case aes_mode::AES_MODE_GCM:
+            TRACE_L1(_T("Unsupported AES cipher block mode"));
+            break;
         default:
             TRACE_L1(_T("not %i  implemented"), mode);
         }
@@ -268,6 +423,12 @@ extern "C" {
         return (implementation);
     }
 
+    struct CipherImplementation* cipher_create_chacha20_poly1305(const struct VaultImplementation* vault VARIABLE_IS_NOT_USED, const uint32_t key_id VARIABLE_IS_NOT_USED)
+    {
+        TRACE_L1(_T("SEC: ChaCha20-Poly1305 is not supported"));
+        return (nullptr);
+    }
+
     void cipher_destroy(struct CipherImplementation* cipher)
     {
         ASSERT(cipher != nullptr);
@@ -288,6 +449,48 @@ extern "C" {
         return (cipher->Decrypt(iv_length, iv, input_length, input, max_output_length, output));
     }
 
+    int32_t cipher_encrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+        const uint32_t aad_length, const uint8_t aad[],
+        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+    {
+        ASSERT(cipher != nullptr);
+        return (cipher->EncryptAEAD(iv_length, iv, aad_length, aad, input_length, input, max_output_length, output));
+    }
+
+    int32_t cipher_decrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+        const uint32_t aad_length, const uint8_t aad[],
+        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+    {
+        ASSERT(cipher != nullptr);
+        return (cipher->DecryptAEAD(iv_length, iv, aad_length, aad, input_length, input, max_output_length, output));
+    }
+
+    struct CipherStreamImplementation* cipher_stream_create(const struct CipherImplementation* cipher, const bool encrypt,
+        const uint8_t iv_length, const uint8_t iv[])
+    {
+        ASSERT(cipher != nullptr);
+        return (cipher->Stream(encrypt, iv_length, iv));
+    }
+
+    void cipher_stream_destroy(struct CipherStreamImplementation* stream)
+    {
+        ASSERT(stream != nullptr);
+        delete stream;
+    }
+
+    int32_t cipher_stream_update(struct CipherStreamImplementation* stream,
+        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[])
+    {
+        ASSERT(stream != nullptr);
+        return (stream->Update(input_length, input, max_output_length, output));
+    }
+
+    int32_t cipher_stream_final(struct CipherStreamImplementation* stream, const uint32_t max_output_length, uint8_t output[])
+    {
+        ASSERT(stream != nullptr);
+        return (stream->Final(max_output_length, output));
+    }
+
 
 } // extern "C"
 
@@ -29,13 +29,45 @@
 #include "Vault.h"
 
 
+struct CipherStreamImplementation {
+    virtual int32_t Update(const uint32_t inputLength, const uint8_t input[],
+        const uint32_t maxOutputLength, uint8_t output[]) = 0;
+
+    virtual int32_t Final(const uint32_t maxOutputLength, uint8_t output[]) = 0;
+
+    virtual ~CipherStreamImplementation() { }
+};
+
 struct CipherImplementation {
+    virtual CipherStreamImplementation* Stream(const bool encrypt VARIABLE_IS_NOT_USED, const uint8_t ivLength VARIABLE_IS_NOT_USED,
+        const uint8_t iv[] VARIABLE_IS_NOT_USED) const
+    {
+        return (nullptr);
+    }
+
     virtual int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[], const uint32_t inputLength,
         const uint8_t input[], const uint32_t maxOutputLength, uint8_t output[]) const = 0;
 
     virtual int32_t Decrypt(const uint8_t ivLength, const uint8_t iv[], const uint32_t inputLength,
         const uint8_t input[], const uint32_t maxOutputLength, uint8_t output[]) const = 0;
 
+    // No authenticated (AEAD) modes on SecApi.
+    virtual int32_t EncryptAEAD(const uint8_t ivLength VARIABLE_IS_NOT_USED, const uint8_t iv[] VARIABLE_IS_NOT_USED,
+        const uint32_t aadLength VARIABLE_IS_NOT_USED, const uint8_t aad[] VARIABLE_IS_NOT_USED,
+        const uint32_t inputLength VARIABLE_IS_NOT_USED, const uint8_t input[] VARIABLE_IS_NOT_USED,
+        const uint32_t maxOutputLength VARIABLE_IS_NOT_USED, uint8_t output[] VARIABLE_IS_NOT_USED) const
+    {
+        return (0);
+    }
+
+    virtual int32_t DecryptAEAD(const uint8_t ivLength VARIABLE_IS_NOT_USED, const uint8_t iv[] VARIABLE_IS_NOT_USED,
+        const uint32_t aadLength VARIABLE_IS_NOT_USED, const uint8_t aad[] VARIABLE_IS_NOT_USED,
+        const uint32_t inputLength VARIABLE_IS_NOT_USED, const uint8_t input[] VARIABLE_IS_NOT_USED,
+        const uint32_t maxOutputLength VARIABLE_IS_NOT_USED, uint8_t output[] VARIABLE_IS_NOT_USED) const
+    {
+        return (0);
+    }
+
     virtual ~CipherImplementation() { }
 };
 
@@ -43,6 +75,30 @@ struct CipherImplementation {
 namespace Implementation {
 
 
+    class CipherStream : public CipherStreamImplementation {
+
+    public:
+
+        CipherStream(const CipherStream&) = delete;
+        CipherStream& operator=(const CipherStream&) = delete;
+        CipherStream(Sec_KeyHandle* key, Sec_CipherHandle* cipher);
+        ~CipherStream() override;
+
+    public:
+
+        int32_t Update(const uint32_t inputLength, const uint8_t input[],
+            const uint32_t maxOutputLength, uint8_t output[]) override;
+
+        int32_t Final(const uint32_t maxOutputLength, uint8_t output[]) override;
+
+    private:
+
+        Sec_KeyHandle* _key;
+        Sec_CipherHandle* _cipher;
+        bool _finished;
+
+    };
+
     class Cipher : public CipherImplementation {
 
     public:
@@ -58,6 +114,8 @@ namespace Implementation {
             const uint8_t input[], const uint32_t maxOutputLength, uint8_t output[]) const;
 
         const Sec_CipherAlgorithm AESCipher(const aes_mode mode);
+        CipherStreamImplementation* Stream(const bool encrypt, const uint8_t ivLength, const uint8_t iv[]) const override;
+
         int32_t Encrypt(const uint8_t ivLength, const uint8_t iv[], const uint32_t inputLength,
             const uint8_t input[], const uint32_t maxOutputLength, uint8_t output[]) const override;
 
@@ -95,6 +95,25 @@ namespace Implementation {
                 return SecDigest_Release(hndle->digest_handle, digestOutput, digestSize);
             }
 
+           /*********************************************************************
+             * @function Start (Digest)
+             *
+             * @brief Wrapper for getting a new digest handle
+             *
+             * @param[in] processor - processor handle
+             * @param[in] digestAlg - digest algorithm
+             * @param[in] macAlg - unused
+             * @param[in] key - unused
+             * @param[out] hndle - digest/mac handle
+             *
+             * @return Sec_Result indicating success or otherwise
+             *
+             *********************************************************************/
+            static Sec_Result Start(Sec_ProcessorHandle* processor, const Sec_DigestAlgorithm digestAlg, const Sec_MacAlgorithm macAlg VARIABLE_IS_NOT_USED,
+                Sec_KeyHandle* key VARIABLE_IS_NOT_USED, Handle* hndle) {
+                return SecDigest_GetInstance(processor, digestAlg, &(hndle->digest_handle));
+            }
+
         };
 
         struct HMAC {
@@ -131,6 +150,25 @@ namespace Implementation {
                 return SecMac_Release(hndle->mac_handle, hmacOutput, hmacSize);
             }
 
+            /*********************************************************************
+             * @function Start (HMAC)
+             *
+             * @brief Wrapper for getting a new mac handle on the key that is kept
+             *
+             * @param[in] processor - processor handle
+             * @param[in] digestAlg - unused
+             * @param[in] macAlg - mac algorithm
+             * @param[in] key - key handle
+             * @param[out] hndle - digest/mac handle
+             *
+             * @return Sec_Result indicating success or otherwise
+             *
+             *********************************************************************/
+            static Sec_Result Start(Sec_ProcessorHandle* processor, const Sec_DigestAlgorithm digestAlg VARIABLE_IS_NOT_USED, const Sec_MacAlgorithm macAlg,
+                Sec_KeyHandle* key, Handle* hndle) {
+                return SecMac_GetInstance(processor, macAlg, key, &(hndle->mac_handle));
+            }
+
         };
 
     } // namespace Operation
@@ -154,13 +192,16 @@ namespace Implementation {
         }
         else {
             if (_vault_digest->getSecProcHandle() != nullptr) {
-                Sec_Result res = SecDigest_GetInstance(_vault_digest->getSecProcHandle(), digestAlg, &(handle->digest_handle));
+                _processor = _vault_digest->getSecProcHandle();
+                _digestAlg = digestAlg;
+                Sec_Result res = SecDigest_GetInstance(_processor, digestAlg, &(handle->digest_handle));
                 if (res != SEC_RESULT_SUCCESS) {
                     TRACE_L1(_T("SEC :SecDigest_GetInstance() failed retVal: %d\n"),res);
                     _failure = true;
                 }
                 else {
                     _size = digestSize;
+                    _active = true;
                     ASSERT(_size != 0);
                 }
             }
@@ -192,7 +233,9 @@ namespace Implementation {
                 TRACE_L2(_T("SEC : the object id sec from export is %llu \n"), _id_sec);
                 Sec_Result sec_res = SecKey_GetInstance(_vault->getSecProcHandle(), _id_sec, &sec_key);
                 if (sec_key != nullptr && sec_res == SEC_RESULT_SUCCESS) {
-                    Sec_Result res = SecMac_GetInstance(_vault->getSecProcHandle(), macAlg, sec_key, &(handle->mac_handle));
+                    _processor = _vault->getSecProcHandle();
+                    _macAlg = macAlg;
+                    Sec_Result res = SecMac_GetInstance(_processor, macAlg, sec_key, &(handle->mac_handle));
                     if (res != SEC_RESULT_SUCCESS) {
                         TRACE_L1(_T("SEC : SecMac_GetInstance() failed reval :%d \n"),res);
                         SecKey_Release(sec_key);
@@ -201,6 +244,7 @@ namespace Implementation {
                     }
                     else {
                         _size = macSize;
+                        _active = true;
                         ASSERT(_size != 0);
                     }
                 }
@@ -220,6 +264,9 @@ namespace Implementation {
     template<typename OPERATION>
     Implementation::HashType<OPERATION>::~HashType()
     {
+        if (_active == true) {
+            Reset();
+        }
         delete handle;
         if (_vault_digest != nullptr) {
             delete _vault_digest;
@@ -244,7 +291,7 @@ namespace Implementation {
     uint32_t Implementation::HashType<OPERATION>::Ingest(const uint32_t length, const uint8_t* data)
     {
         ASSERT(data != nullptr);
-        if (false == _failure) {
+        if ((false == _failure) && ((true == _active) || (true == Restart()))) {
             SEC_BYTE* data_digest = const_cast<SEC_BYTE*>(data);
             Sec_Result retVal = OPERATION::Update(handle, data_digest, length);
             if ( SEC_RESULT_SUCCESS == retVal) {
@@ -280,9 +327,15 @@ namespace Implementation {
             if (maxLength < _size) {
                 TRACE_L1(_T("Output buffer to small, need %i bytes, got %i bytes"), _size, maxLength);
             }
-            else {
-                size_t len = maxLength;
-                Sec_Result res = OPERATION::Final(handle, data, &len);
+            else if ((false == _active) && (_length != 0)) {
+                // Calculated before and nothing ingested since
+                ::memcpy(data, _digest, _length);
+                result = _length;
+            }
+            else if ((true == _active) || (true == Restart())) {
+                size_t len = sizeof(_digest);
+                Sec_Result res = OPERATION::Final(handle, _digest, &len);
+                _active = false;
                 if (res != SEC_RESULT_SUCCESS) {
                     TRACE_L1(_T("Final() failed retVal = %d"),res);
                     _failure = true;
@@ -290,7 +343,9 @@ namespace Implementation {
                 else {
                     TRACE_L2(_T("Calculated hash successfully, size: %i bytes"), len);
                     ASSERT(len == _size);
-                    result = len;
+                    _length = static_cast<uint8_t>(len);
+                    ::memcpy(data, _digest, _length);
+                    result = _length;
                 }
             }
         }
@@ -298,7 +353,48 @@ namespace Implementation {
 
     }
 
+    template<typename OPERATION>
+    /*********************************************************************
+     * @function Reset
+     *
+     * @brief    Drop the data ingested since the last calculation
+     *
+     *********************************************************************/
+    void Implementation::HashType<OPERATION>::Reset()
+    {
+        if (true == _active) {
+            uint8_t scratch[sizeof(_digest)];
+            size_t len = sizeof(scratch);
+            OPERATION::Final(handle, scratch, &len);
+            ::memset(scratch, 0x00, sizeof(scratch));
+            _active = false;
+        }
+        _length = 0;
+        ::memset(_digest, 0x00, sizeof(_digest));
+    }
 
+    template<typename OPERATION>
+    /*********************************************************************
+     * @function Restart
+     *
+     * @brief    Get a new digest/mac handle, the key handle is kept so
+     *           the key is not looked up again
+     *
+     * @return true if a new calculation was started
+     *
+     *********************************************************************/
+    bool Implementation::HashType<OPERATION>::Restart()
+    {
+        _length = 0;
+        Sec_Result res = OPERATION::Start(_processor, _digestAlg, _macAlg, sec_key, handle);
+        if (res != SEC_RESULT_SUCCESS) {
+            TRACE_L1(_T("SEC : Start() failed retVal = %d"),res);
+        }
+        else {
+            _active = true;
+        }
+        return (_active);
+    }
 
 } // namespace Implementation
 
@@ -372,5 +468,75 @@ extern "C" {
         return (hash->Calculate(max_length, data));
     }
 
+    void hash_reset(HashImplementation* hash)
+    {
+        ASSERT(hash != nullptr);
+        hash->Reset();
+    }
+
+    HashImplementation* hash_clone(const HashImplementation* hash VARIABLE_IS_NOT_USED)
+    {
+        ASSERT(hash != nullptr);
+        // The SEC handles can not be duplicated, create a new object instead.
+        TRACE_L1(_T("SEC: hash_clone() is not supported"));
+        return (nullptr);
+    }
+
+    uint8_t hash_size(const hash_type type)
+    {
+        const HashAlg* secalg = Implementation::Algorithm(type);
+        const uint8_t size = static_cast<uint8_t>(secalg->size);
+        delete secalg;
+        return (size);
+    }
+
+    uint32_t hash_calculate_batch(const hash_type type, const uint32_t count, const uint32_t lengths[], const uint8_t* const data[],
+                                  const uint32_t max_length, uint8_t digests[])
+    {
+        ASSERT((count == 0) || ((lengths != nullptr) && (data != nullptr) && (digests != nullptr)));
+
+        uint32_t result = 0;
+        const uint8_t size = hash_size(type);
+
+        if (size == 0) {
+            TRACE_L1(_T("SEC: Hash batch failure"));
+        }
+        else if ((static_cast<uint64_t>(count) * size) > max_length) {
+            TRACE_L1(_T("Output buffer to small, need %i bytes, got %i bytes"), (count * size), max_length);
+        }
+        else {
+            // One digest object for the whole batch, it takes a new digest
+            // handle per message but the processor handle is set up once.
+            HashImplementation* hash = hash_create(type);
+
+            if (hash != nullptr) {
+                uint8_t* digest = digests;
+
+                while (result < count) {
+                    if (lengths[result] == 0) {
+                        // Otherwise the previous digest is handed out again
+                        hash->Reset();
+                    }
+                    if (((lengths[result] != 0) && (hash->Ingest(lengths[result], data[result]) != lengths[result]))
+                        || (hash->Calculate(size, digest) != size)) {
+                        TRACE_L1(_T("SEC: Hash batch failed at message %i"), result);
+                        break;
+                    }
+                    digest += size;
+                    result++;
+                }
+
+                delete hash;
+            }
+
+            if (result != count) {
+                ::memset(digests, 0x00, (count * size));
+                result = 0;
+            }
+        }
+
+        return (result);
+    }
+
 } // extern "C"
 
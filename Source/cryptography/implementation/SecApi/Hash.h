@@ -30,6 +30,7 @@
 struct HashImplementation {
     virtual uint32_t Ingest(const uint32_t length, const uint8_t data[]) = 0;
     virtual uint8_t Calculate(const uint8_t maxLength, uint8_t data[]) = 0;
+    virtual void Reset() = 0;
 
     virtual ~HashImplementation() { }
 };
@@ -65,10 +66,20 @@ namespace Implementation {
         Handle* handle = new Handle;
         Sec_KeyHandle* sec_key = nullptr;
         SEC_OBJECTID _id_sec;
+        Sec_ProcessorHandle* _processor = nullptr;
+        Sec_DigestAlgorithm _digestAlg = SEC_DIGESTALGORITHM_NUM;
+        Sec_MacAlgorithm _macAlg = SEC_MACALGORITHM_NUM;
+        bool _active = false;
+        uint8_t _length = 0;
+        uint8_t _digest[32]; // SHA-1 and SHA-256 only
+
+    private:
+        bool Restart();
 
     public:
         uint32_t Ingest(const uint32_t length, const uint8_t* data) override;
         uint8_t Calculate(const uint8_t maxLength, uint8_t* data) override;
+        void Reset() override;
 
     };
 
@@ -79,11 +90,13 @@ namespace Implementation {
         Sec_NetflixHandle* _netflixHandle;
         Sec_SocKeyHandle* _secretKey = NULL;
         std::string _buffer = "";
+        bool _done = false;
 
     public:
         HashTypeNetflix(const Implementation::VaultNetflix* vault, const uint32_t secretId);
         uint32_t Ingest(const uint32_t length, const uint8_t* data) override;
         uint8_t Calculate(const uint8_t maxLength, uint8_t* data) override;
+        void Reset() override;
     };
 
 } // namespace Implementation
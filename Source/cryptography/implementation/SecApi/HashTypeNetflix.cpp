@@ -50,6 +50,11 @@ uint32_t Implementation::HashTypeNetflix::Ingest(const uint32_t length, const ui
 {
     ASSERT(data != nullptr);
     if (false == _failure) {
+        if (true == _done) {
+            // First data after a calculation, start a new message
+            _buffer.clear();
+            _done = false;
+        }
         _buffer.append(reinterpret_cast<const char*>(data), length);
     }
     else {
@@ -89,6 +94,7 @@ uint8_t Implementation::HashTypeNetflix::Calculate(const uint8_t maxLength, uint
             if (result_sec == SEC_RESULT_SUCCESS) {
                 memcpy(data, sig_data, bytesWritten);
                 result = bytesWritten;
+                _done = true;
                 TRACE_L2(_T("SEC:HMAC signature calculated  bytes written is %d and maxLength is %d  \n"), bytesWritten, maxLength);
             }
             else { 
@@ -99,3 +105,14 @@ uint8_t Implementation::HashTypeNetflix::Calculate(const uint8_t maxLength, uint
     return (result);
 }
 
+/*********************************************************************
+ * @function Reset
+ *
+ * @brief    Drop the data ingested since the last calculation
+ *
+ *********************************************************************/
+void Implementation::HashTypeNetflix::Reset()
+{
+    _buffer.clear();
+    _done = false;
+}
@@ -40,9 +40,7 @@ const uint32_t encryptionIVId = 2;
 }
 
 Vault::Vault()
-    : _lock()
-    , _items()
-    , _lastHandle(0x80000000)
+    : _items()
 {
     typedef uint8_t pkey[16];
 
@@ -53,13 +51,10 @@ Vault::Vault()
         { 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11, 0x22, 0x33 },
     };
 
-    _lock.Lock();
     for (uint8_t i = 0; i < (sizeof(privateKeys) / sizeof(pkey)); i++) {
-        _items.emplace(std::piecewise_construct,
-                    std::forward_as_tuple(i + 1),
-                    std::forward_as_tuple(false, sizeof(privateKeys[i]), privateKeys[i]));
+        VARIABLE_IS_NOT_USED uint32_t id = _items.Insert(new Element(false, sizeof(privateKeys[i]), privateKeys[i]), (i + 1));
+        ASSERT(id == static_cast<uint32_t>(i + 1));
     }
-    _lock.Unlock();
 }
 
 uint16_t Vault::Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[], const uint16_t maxOutSize, uint8_t output[]) const
@@ -82,11 +77,10 @@ uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
 {
     uint16_t size = 0;
 
-    _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        if ((allowSealed == true) || (*it).second.IsExportable() == true) {
-            size = (*it).second.Size();
+    HandleTable<Element>::Reference element(_items, id);
+    if (element.IsValid() == true) {
+        if ((allowSealed == true) || element->IsExportable() == true) {
+            size = element->Size();
             TRACE_L2(_T("Blob id 0x%08x size: %i"), id, size);
         } else {
             TRACE_L2(_T("Blob id 0x%08x is sealed"), id);
@@ -95,7 +89,6 @@ uint16_t Vault::Size(const uint32_t id, bool allowSealed) const
     } else {
         TRACE_L1(_T("Failed to look up blob id 0x%08x"), id);
     }
-    _lock.Unlock();
 
     return (size);
 }
@@ -105,22 +98,16 @@ uint32_t Vault::Import(const uint16_t size, const uint8_t blob[], bool exportabl
     uint32_t id = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
+        uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
+        uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
 
-        if (id != 0) {
-            uint8_t* buf = reinterpret_cast<uint8_t*>(ALLOCA(USHRT_MAX));
-            uint16_t len = Cipher(true, size, blob, USHRT_MAX, buf);
-
-            _items.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(id),
-                           std::forward_as_tuple(exportable, len, buf));
-
-            _lastHandle = id;
+        id = _items.Insert(new Element(exportable, len, buf));
 
+        if (id != 0) {
             TRACE_L2(_T("Added a %s data blob of size %i as id 0x%08x"), (exportable? "clear": "sealed"), len, id);
+        } else {
+            TRACE_L1(_T("Failed to add a data blob, the vault is full"));
         }
-        _lock.Unlock();
     }
 
     return (id);
@@ -131,11 +118,10 @@ uint16_t Vault::Export(const uint32_t id, const uint16_t size, uint8_t blob[], b
     uint16_t outSize = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            if ((allowSealed == true) || ((*it).second.IsExportable() == true)) {
-                outSize = Cipher(false, (*it).second.Size(), (*it).second.Buffer(), size, blob);
+        HandleTable<Element>::Reference element(_items, id);
+        if (element.IsValid() == true) {
+            if ((allowSealed == true) || (element->IsExportable() == true)) {
+                outSize = Cipher(false, element->Size(), element->Buffer(), size, blob);
 
                 TRACE_L2(_T("Exported %i bytes from blob id 0x%08x"), outSize, id);
             } else {
@@ -144,7 +130,6 @@ uint16_t Vault::Export(const uint32_t id, const uint16_t size, uint8_t blob[], b
         } else {
             TRACE_L1(_T("Failed to look up blob id 0x%08x"), id);
         }
-        _lock.Unlock();
     }
 
     return (outSize);
@@ -155,18 +140,13 @@ uint32_t Vault::Put(const uint16_t size, const uint8_t blob[])
     uint32_t id = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        id = (_lastHandle + 1);
-        if (id != 0) {
-            _items.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(id),
-                           std::forward_as_tuple(false, size, blob));
-
-            _lastHandle = id;
+        id = _items.Insert(new Element(false, size, blob));
 
+        if (id != 0) {
             TRACE_L2(_T("Inserted a sealed data blob of size %i as id 0x%08x"), size, id);
+        } else {
+            TRACE_L1(_T("Failed to insert a data blob, the vault is full"));
         }
-        _lock.Unlock();
     }
 
     return (id);
@@ -177,14 +157,12 @@ uint16_t Vault::Get(const uint32_t id, const uint16_t size, uint8_t blob[]) cons
     uint16_t result = 0;
 
     if (size > 0) {
-        _lock.Lock();
-        auto it = _items.find(id);
-        if (it != _items.end()) {
-            result = std::min(size, static_cast<uint16_t>((*it).second.Size()));
-            ::memcpy(blob, (*it).second.Buffer(), result);
+        HandleTable<Element>::Reference element(_items, id);
+        if (element.IsValid() == true) {
+            result = std::min(size, static_cast<uint16_t>(element->Size()));
+            ::memcpy(blob, element->Buffer(), result);
             TRACE_L2(_T("Retrieved a sealed data blob id 0x%08x of size %i bytes"), id, result);
         }
-        _lock.Unlock();
     }
 
     return (result);
@@ -192,17 +170,7 @@ uint16_t Vault::Get(const uint32_t id, const uint16_t size, uint8_t blob[]) cons
 
 bool Vault::Dispose(const uint32_t id)
 {
-    bool result = false;
-
-   _lock.Lock();
-    auto it = _items.find(id);
-    if (it != _items.end()) {
-        _items.erase(it);
-        result = true;
-    }
-    _lock.Unlock();
-
-    return (result);
+    return (_items.Remove(id));
 }
 
 } // namespace Implementation
@@ -18,7 +18,7 @@
  */
 
 #include "../../Module.h"
-#include <map>
+#include "../HandleTable.h"
 
 namespace Implementation {
 
@@ -71,9 +71,7 @@ private:
     uint16_t Cipher(bool encrypt, const uint16_t inSize, const uint8_t input[], const uint16_t maxOutSize, uint8_t output[]) const;
 
 private:
-    mutable Thunder::Core::CriticalSection _lock;
-    std::map<uint32_t, Element> _items;
-    uint32_t _lastHandle;
+    HandleTable<Element> _items;
 };
 
 } // namespace Implementation
@@ -35,13 +35,21 @@ typedef enum {
     AES_MODE_CFB8,
     AES_MODE_CFB128,
     AES_MODE_CTR,
+    AES_MODE_GCM,
 } aes_mode;
 
 struct CipherImplementation;
 
+struct CipherStreamImplementation;
+
 
 EXTERNAL struct CipherImplementation* cipher_create_aes(const struct VaultImplementation* vault, const aes_mode mode, const uint32_t key_id);
 
+/* Authenticated encryption (AES_MODE_GCM and ChaCha20-Poly1305) takes a 12 byte IV, the ciphertext is followed by
+   a 16 byte tag. A plain cipher_encrypt()/cipher_decrypt() on such a cipher authenticates without additional data.
+   Decryption fails, returning 0, if the tag does not match. Streaming is not available for these. */
+EXTERNAL struct CipherImplementation* cipher_create_chacha20_poly1305(const struct VaultImplementation* vault, const uint32_t key_id);
+
 EXTERNAL void cipher_destroy(struct CipherImplementation* cipher);
 
 EXTERNAL int32_t cipher_encrypt(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
@@ -50,6 +58,28 @@ EXTERNAL int32_t cipher_encrypt(const struct CipherImplementation* cipher, const
 EXTERNAL int32_t cipher_decrypt(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
                         const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[]);
 
+EXTERNAL int32_t cipher_encrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+                        const uint32_t aad_length, const uint8_t aad[],
+                        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[]);
+
+EXTERNAL int32_t cipher_decrypt_aead(const struct CipherImplementation* cipher, const uint8_t iv_length, const uint8_t iv[],
+                        const uint32_t aad_length, const uint8_t aad[],
+                        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[]);
+
+/* Streaming: the input is passed in chunks through cipher_stream_update(), the chaining state is carried over
+   between the chunks. An update needs room for the input plus one block (padded modes hold back the last block),
+   otherwise the negative of the required size is returned. cipher_stream_final() flushes the remainder.
+   A stream uses the key of its cipher, so it must be destroyed before the cipher it was created on. */
+EXTERNAL struct CipherStreamImplementation* cipher_stream_create(const struct CipherImplementation* cipher, const bool encrypt,
+                        const uint8_t iv_length, const uint8_t iv[]);
+
+EXTERNAL void cipher_stream_destroy(struct CipherStreamImplementation* stream);
+
+EXTERNAL int32_t cipher_stream_update(struct CipherStreamImplementation* stream,
+                        const uint32_t input_length, const uint8_t input[], const uint32_t max_output_length, uint8_t output[]);
+
+EXTERNAL int32_t cipher_stream_final(struct CipherStreamImplementation* stream, const uint32_t max_output_length, uint8_t output[]);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
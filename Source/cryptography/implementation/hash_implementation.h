@@ -48,6 +48,25 @@ EXTERNAL uint32_t hash_ingest(struct HashImplementation* signing, const uint32_t
 
 EXTERNAL uint8_t hash_calculate(struct HashImplementation* signing, const uint8_t max_length, uint8_t data[]);
 
+/* A hash object can be reused: the first ingest after hash_calculate() starts a new digest, for HMAC from the keyed
+   state set up when the object was created. hash_reset() drops whatever was ingested since the last calculation. */
+EXTERNAL void hash_reset(struct HashImplementation* signing);
+
+/* A hash object holds one calculation at a time. It may be passed between threads, but threads hashing in parallel
+   need an object each: hash_clone() creates one from the same algorithm and, for HMAC, the same keyed state, without
+   going through the vault again. Nothing ingested into the source is carried over. Returns NULL if the backend can
+   not clone; the clone is released with hash_destroy(). */
+EXTERNAL struct HashImplementation* hash_clone(const struct HashImplementation* signing);
+
+/* Size in bytes of the digests of the given type, 0 if the type is not supported. */
+EXTERNAL uint8_t hash_size(const hash_type type);
+
+/* Hashes count independent messages in one call, without creating a hash object per message. The digest of message i
+   is written at digests + (i * hash_size(type)), so max_length must be at least count * hash_size(type). Returns the
+   number of digests calculated, which is count on success and 0 on failure. */
+EXTERNAL uint32_t hash_calculate_batch(const hash_type type, const uint32_t count, const uint32_t lengths[], const uint8_t* const data[],
+                                       const uint32_t max_length, uint8_t digests[]);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,255 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <implementation/vault_implementation.h>
+#include <implementation/cipher_implementation.h>
+#include <implementation/hash_implementation.h>
+
+static struct VaultImplementation* vault = NULL;
+
+static const uint8_t key128[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11 };
+static const uint8_t iv[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+static const uint32_t messageSizes[] = { 64, 256, 1024, 4096, 16384, 65536 };
+
+/* Runs the operation for the given time, returns the operations per second. */
+template <typename OPERATION>
+static uint64_t Measure(const uint32_t milliseconds, OPERATION operation)
+{
+    uint64_t count = 0;
+    const uint64_t start = Thunder::Core::Time::Now().Ticks();
+    const uint64_t deadline = start + (milliseconds * Thunder::Core::Time::TicksPerMillisecond);
+    uint64_t now = start;
+
+    do {
+        for (uint8_t batch = 0; batch < 16; batch++) {
+            operation();
+        }
+        count += 16;
+        now = Thunder::Core::Time::Now().Ticks();
+    } while (now < deadline);
+
+    return ((count * 1000 * Thunder::Core::Time::TicksPerMillisecond) / (now - start));
+}
+
+/*
+  ===================================
+    CIPHER
+  ===================================
+*/
+
+static void BenchmarkCipher(const char* name, const aes_mode mode, const uint32_t keyId, const uint32_t milliseconds)
+{
+    printf("======== Cipher::%s\n", name);
+    printf("  %8s %14s %14s %10s\n", "size", "per call op/s", "keyed op/s", "keyed MB/s");
+
+    uint8_t* input = static_cast<uint8_t*>(malloc(messageSizes[(sizeof(messageSizes) / sizeof(messageSizes[0])) - 1]));
+    uint8_t* output = static_cast<uint8_t*>(malloc(messageSizes[(sizeof(messageSizes) / sizeof(messageSizes[0])) - 1] + 16));
+
+    for (uint8_t index = 0; index < (sizeof(messageSizes) / sizeof(messageSizes[0])); index++) {
+        const uint32_t size = messageSizes[index];
+
+        memset(input, (0x74 + index), size);
+
+        /* A cipher per message pays the key export and key schedule on every operation. */
+        const uint64_t perCall = Measure(milliseconds, [&]() {
+            struct CipherImplementation* cipher = cipher_create_aes(vault, mode, keyId);
+            if (cipher != NULL) {
+                cipher_encrypt(cipher, sizeof(iv), iv, size, input, (size + 16), output);
+                cipher_destroy(cipher);
+            }
+        });
+
+        struct CipherImplementation* cipher = cipher_create_aes(vault, mode, keyId);
+
+        if (cipher == NULL) {
+            printf("  FATAL: Failed to create cipher, %s benchmark will be skipped\n", name);
+            break;
+        }
+
+        const uint64_t keyed = Measure(milliseconds, [&]() {
+            cipher_encrypt(cipher, sizeof(iv), iv, size, input, (size + 16), output);
+        });
+
+        cipher_destroy(cipher);
+
+        printf("  %8u %14llu %14llu %10.1f\n", size, static_cast<unsigned long long>(perCall),
+            static_cast<unsigned long long>(keyed), ((static_cast<double>(keyed) * size) / (1024.0 * 1024.0)));
+    }
+
+    free(output);
+    free(input);
+
+    printf("\n");
+}
+
+/*
+  ===================================
+    HASH
+  ===================================
+*/
+
+static const uint32_t batchSizes[] = { 32, 64, 256, 1024 };
+static const uint32_t batchCount = 256;
+
+/* Many small independent messages, e.g. per chunk checksums, hashed one object per message and as one batch. */
+static void BenchmarkHashBatch(const char* name, const hash_type type, const uint32_t milliseconds)
+{
+    printf("======== Hash::%s batch of %u\n", name, batchCount);
+    printf("  %8s %14s %14s %10s\n", "size", "per msg msg/s", "batch msg/s", "batch MB/s");
+
+    const uint8_t digestSize = hash_size(type);
+    uint8_t* input = static_cast<uint8_t*>(malloc(batchSizes[(sizeof(batchSizes) / sizeof(batchSizes[0])) - 1] * batchCount));
+    uint8_t* digests = static_cast<uint8_t*>(malloc(batchCount * digestSize));
+    const uint8_t** data = static_cast<const uint8_t**>(malloc(batchCount * sizeof(uint8_t*)));
+    uint32_t* lengths = static_cast<uint32_t*>(malloc(batchCount * sizeof(uint32_t)));
+
+    for (uint8_t index = 0; index < (sizeof(batchSizes) / sizeof(batchSizes[0])); index++) {
+        const uint32_t size = batchSizes[index];
+
+        memset(input, (0x74 + index), (size * batchCount));
+
+        for (uint32_t message = 0; message < batchCount; message++) {
+            data[message] = &input[message * size];
+            lengths[message] = size;
+        }
+
+        const uint64_t perMessage = Measure(milliseconds, [&]() {
+            for (uint32_t message = 0; message < batchCount; message++) {
+                struct HashImplementation* hash = hash_create(type);
+                if (hash != NULL) {
+                    hash_ingest(hash, lengths[message], data[message]);
+                    hash_calculate(hash, digestSize, &digests[message * digestSize]);
+                    hash_destroy(hash);
+                }
+            }
+        }) * batchCount;
+
+        const uint64_t batch = Measure(milliseconds, [&]() {
+            hash_calculate_batch(type, batchCount, lengths, data, (batchCount * digestSize), digests);
+        }) * batchCount;
+
+        printf("  %8u %14llu %14llu %10.1f\n", size, static_cast<unsigned long long>(perMessage),
+            static_cast<unsigned long long>(batch), ((static_cast<double>(batch) * size) / (1024.0 * 1024.0)));
+    }
+
+    free(lengths);
+    free(data);
+    free(digests);
+    free(input);
+
+    printf("\n");
+}
+
+/*
+  ===================================
+    VAULT
+  ===================================
+*/
+
+static const uint8_t vaultThreads[] = { 1, 2, 4, 8, 16 };
+
+/* Every cipher and HMAC creation looks its key up in the vault, this measures the lookups under contention. */
+static void BenchmarkVault(const uint32_t keyId, const uint32_t milliseconds)
+{
+    printf("======== Vault::Lookup\n");
+    printf("  %8s %14s %14s\n", "threads", "total op/s", "per thread");
+
+    for (uint8_t index = 0; index < (sizeof(vaultThreads) / sizeof(vaultThreads[0])); index++) {
+        const uint8_t threads = vaultThreads[index];
+        std::atomic<uint64_t> total(0);
+        std::vector<std::thread> workers;
+
+        for (uint8_t thread = 0; thread < threads; thread++) {
+            workers.emplace_back([&]() {
+                uint8_t buffer[64];
+                total += Measure(milliseconds, [&]() {
+                    if (vault_size(vault, keyId) != 0) {
+                        vault_export(vault, keyId, sizeof(buffer), buffer);
+                    }
+                });
+            });
+        }
+
+        /* Keys coming and going must not hold up the lookups. */
+        std::atomic<bool> done(false);
+        std::thread writer([&]() {
+            const uint8_t key[16] = { 0 };
+            while (done == false) {
+                const uint32_t id = vault_import(vault, sizeof(key), key);
+                if (id != 0) {
+                    vault_delete(vault, id);
+                }
+            }
+        });
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        done = true;
+        writer.join();
+
+        printf("  %8u %14llu %14llu\n", threads, static_cast<unsigned long long>(total.load()), static_cast<unsigned long long>(total.load() / threads));
+    }
+
+    printf("\n");
+}
+
+/*
+  ===================================
+*/
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t milliseconds = (argc > 1 ? atoi(argv[1]) : 1000);
+
+    vault = vault_instance(CRYPTOGRAPHY_VAULT_NETFLIX);
+
+    if (vault == NULL) {
+        printf("FATAL: No vault available\n");
+        return (1);
+    }
+
+    BenchmarkHashBatch("SHA256", HASH_TYPE_SHA256, milliseconds);
+
+    uint32_t keyId = vault_import(vault, sizeof(key128), key128);
+
+    if (keyId == 0) {
+        printf("FATAL: Failed to store key to vault, cipher benchmarks will be skipped\n");
+    } else {
+        BenchmarkCipher("AES_128_CBC", AES_MODE_CBC, keyId, milliseconds);
+        BenchmarkCipher("AES_128_CTR", AES_MODE_CTR, keyId, milliseconds);
+        BenchmarkVault(keyId, milliseconds);
+        vault_delete(vault, keyId);
+    }
+
+    return (0);
+}
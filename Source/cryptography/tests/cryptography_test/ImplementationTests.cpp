@@ -27,6 +27,13 @@
 #include <stdbool.h>
 #include <limits.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <openssl/dh.h>
 #include <openssl/hmac.h>
 #include <openssl/sha.h>
@@ -35,6 +42,8 @@
 #include <implementation/hash_implementation.h>
 #include <implementation/cipher_implementation.h>
 #include <implementation/diffiehellman_implementation.h>
+#include <implementation/persistent_implementation.h>
+#include <implementation/random_implementation.h>
 
 #include "Helpers.h"
 #include "Test.h"
@@ -202,6 +211,52 @@ TEST(Vault, SetGet)
     EXPECT_EQ(vault_size(vault, id4), 0);
 }
 
+TEST(Vault, Persistent)
+{
+    const uint8_t iv[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    const uint8_t data[] = "Etaoin Shrdlu...";
+    uint8_t first[32];
+    uint8_t second[32];
+    bool exists = false;
+    uint32_t id = 0;
+
+    if (persistent_key_exists(vault, "cgimptests", &exists) != 0) {
+        printf("  FATAL: No persistent key store available, persistent key tests will be skipped\n");
+        return;
+    }
+
+    EXPECT_EQ(persistent_key_create(vault, "cgimptests", AES128, &id), 0);
+    EXPECT_NE(id, 0);
+    EXPECT_EQ(persistent_key_exists(vault, "cgimptests", &exists), 0);
+    EXPECT_EQ(exists, true);
+    EXPECT_EQ(persistent_flush(vault), 0);
+
+    /* A created key is sealed */
+    EXPECT_EQ(vault_size(vault, id), USHRT_MAX);
+
+    struct CipherImplementation* cipher = cipher_create_aes(vault, AES_MODE_CBC, id);
+    EXPECT_NE(cipher != NULL, false);
+    if (cipher != NULL) {
+        EXPECT_EQ(cipher_encrypt(cipher, sizeof(iv), iv, (sizeof(data) - 1), data, sizeof(first), first), 32);
+        cipher_destroy(cipher);
+    }
+    EXPECT_NE(vault_delete(vault, id), false);
+
+    /* Loading it again gives the same key */
+    EXPECT_EQ(persistent_key_load(vault, "cgimptests", &id), 0);
+    EXPECT_NE(id, 0);
+    cipher = cipher_create_aes(vault, AES_MODE_CBC, id);
+    EXPECT_NE(cipher != NULL, false);
+    if (cipher != NULL) {
+        EXPECT_EQ(cipher_encrypt(cipher, sizeof(iv), iv, (sizeof(data) - 1), data, sizeof(second), second), 32);
+        EXPECT_EQ(memcmp(first, second, sizeof(first)), 0);
+        cipher_destroy(cipher);
+    }
+    EXPECT_NE(vault_delete(vault, id), false);
+
+    EXPECT_NE(persistent_key_load(vault, "cgimptests-unknown", &id), 0);
+}
+
 /*
   ===================================
     HASH
@@ -375,6 +430,148 @@ TEST(Signing, HMAC)
     }
 }
 
+TEST(Signing, Reuse)
+{
+    const uint8_t data[] = "Etaoin Shrldu";
+    const uint8_t password[] = "Thunder";
+    const uint8_t hash_sha256[] = { 0x2D, 0xF5, 0x9C, 0xBE, 0x61, 0x59, 0x7F, 0x14, 0xEC, 0xD2, 0x85, 0x6F,
+                                    0xAB, 0xF1, 0x12, 0xFC, 0xF4, 0x68, 0x6D, 0xFE, 0x93, 0x5F, 0xDB, 0xB7,
+                                    0x34, 0x8C, 0x6C, 0x6B, 0xF1, 0x64, 0xE9, 0x27 };
+
+    uint32_t secret = vault_import(vault, (sizeof(password) - 1), password);
+    if (secret != 0) {
+        struct HashImplementation* hash = hash_create_hmac(vault, HASH_TYPE_SHA256, secret);
+        EXPECT_NE(hash != NULL, false);
+
+        if (hash != NULL) {
+            uint8_t output[32];
+
+            /* One object, many messages, each from the keyed state */
+            for (uint8_t round = 0; round < 4; round++) {
+                memset(output, 0, sizeof(output));
+                EXPECT_EQ(hash_ingest(hash, (sizeof(data) - 1), data), (sizeof(data) - 1));
+                EXPECT_EQ(hash_calculate(hash, sizeof(output), output), sizeof(output));
+                EXPECT_EQ(memcmp(output, hash_sha256, sizeof(hash_sha256)), 0);
+            }
+
+            /* A reset drops the data ingested so far */
+            EXPECT_EQ(hash_ingest(hash, 6, reinterpret_cast<const uint8_t*>("Thunder")), 6);
+            hash_reset(hash);
+            EXPECT_EQ(hash_ingest(hash, (sizeof(data) - 1), data), (sizeof(data) - 1));
+            EXPECT_EQ(hash_calculate(hash, sizeof(output), output), sizeof(output));
+            EXPECT_EQ(memcmp(output, hash_sha256, sizeof(hash_sha256)), 0);
+
+            hash_destroy(hash);
+        }
+
+        EXPECT_NE(vault_delete(vault, secret), false);
+    } else {
+        printf("FATAL: Failed to store secret into vault, HMAC reuse tests are skipped\n");
+    }
+}
+
+TEST(Signing, Batch)
+{
+    const uint8_t data[] = "Etaoin Shrldu";
+    const uint8_t hash_sha256[] = { 0x80, 0x72, 0xA8, 0x3C, 0x2C, 0xFB, 0xF3, 0x67, 0xA1, 0x64, 0x1C, 0x22,
+                                    0x03, 0xCD, 0x78, 0x1D, 0x2E, 0x85, 0x13, 0x11, 0x72, 0x7D, 0xCE, 0x8E,
+                                    0xD7, 0x25, 0x51, 0x0F, 0xE1, 0x3B, 0x78, 0x35 };
+    const uint8_t hash_empty[] = { 0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8,
+                                   0x99, 0x6F, 0xB9, 0x24, 0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C,
+                                   0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55 };
+
+    uint8_t large[300];
+    memset(large, 0x5A, sizeof(large));
+
+    const uint8_t* messages[] = { data, NULL, large, data };
+    const uint32_t lengths[] = { (sizeof(data) - 1), 0, sizeof(large), (sizeof(data) - 1) };
+    const uint32_t count = (sizeof(lengths) / sizeof(lengths[0]));
+    uint8_t digests[count * 32];
+
+    EXPECT_EQ(hash_size(HASH_TYPE_SHA256), 32);
+
+    memset(digests, 0, sizeof(digests));
+    EXPECT_EQ(hash_calculate_batch(HASH_TYPE_SHA256, count, lengths, messages, (sizeof(digests) - 1), digests), 0);
+    EXPECT_EQ(hash_calculate_batch(HASH_TYPE_SHA256, count, lengths, messages, sizeof(digests), digests), count);
+    EXPECT_EQ(memcmp(&digests[0 * 32], hash_sha256, sizeof(hash_sha256)), 0);
+    EXPECT_EQ(memcmp(&digests[1 * 32], hash_empty, sizeof(hash_empty)), 0);
+    EXPECT_EQ(memcmp(&digests[3 * 32], hash_sha256, sizeof(hash_sha256)), 0);
+
+    /* Same digest as a hash object per message */
+    struct HashImplementation* hash = hash_create(HASH_TYPE_SHA256);
+    EXPECT_NE(hash != NULL, false);
+
+    if (hash != NULL) {
+        uint8_t output[32];
+        EXPECT_EQ(hash_ingest(hash, sizeof(large), large), sizeof(large));
+        EXPECT_EQ(hash_calculate(hash, sizeof(output), output), sizeof(output));
+        EXPECT_EQ(memcmp(&digests[2 * 32], output, sizeof(output)), 0);
+        hash_destroy(hash);
+    }
+}
+
+/*
+  ===================================
+    RANDOM
+  ===================================
+*/
+
+TEST(Random, Generate)
+{
+    const uint8_t zeros[64] = { 0 };
+    uint8_t first[64];
+    uint8_t second[64];
+
+    /* Small requests come from a buffer, large ones are generated directly */
+    const uint16_t lengths[] = { 1, 16, 64 };
+    for (uint8_t index = 0; index < (sizeof(lengths) / sizeof(lengths[0])); index++) {
+        memset(first, 0, sizeof(first));
+        memset(second, 0, sizeof(second));
+        EXPECT_EQ(random_generate(lengths[index], first), lengths[index]);
+        EXPECT_EQ(random_generate(lengths[index], second), lengths[index]);
+        if (lengths[index] >= 16) {
+            EXPECT_NE(memcmp(first, second, lengths[index]), 0);
+            EXPECT_NE(memcmp(first, zeros, lengths[index]), 0);
+        }
+    }
+
+    uint8_t* large = static_cast<uint8_t*>(malloc(USHRT_MAX));
+    EXPECT_EQ(random_generate(USHRT_MAX, large), USHRT_MAX);
+    EXPECT_NE(memcmp(large, zeros, sizeof(zeros)), 0);
+    EXPECT_NE(memcmp(&large[USHRT_MAX - sizeof(zeros)], zeros, sizeof(zeros)), 0);
+    free(large);
+
+    /* Another thread gets other bytes */
+    std::thread thread([&]() {
+        EXPECT_EQ(random_generate(sizeof(second), second), sizeof(second));
+    });
+    thread.join();
+    EXPECT_EQ(random_generate(sizeof(first), first), sizeof(first));
+    EXPECT_NE(memcmp(first, second, sizeof(first)), 0);
+
+    /* A forked child must not repeat what the parent hands out next */
+    int channel[2];
+    if (pipe(channel) == 0) {
+        pid_t child = fork();
+
+        if (child == 0) {
+            uint8_t output[64];
+            uint16_t length = random_generate(sizeof(output), output);
+            VARIABLE_IS_NOT_USED ssize_t written = write(channel[1], output, length);
+            _exit(0);
+        } else if (child > 0) {
+            waitpid(child, NULL, 0);
+            memset(second, 0, sizeof(second));
+            EXPECT_EQ(read(channel[0], second, sizeof(second)), static_cast<ssize_t>(sizeof(second)));
+            EXPECT_EQ(random_generate(sizeof(first), first), sizeof(first));
+            EXPECT_NE(memcmp(first, second, sizeof(first)), 0);
+        }
+
+        close(channel[0]);
+        close(channel[1]);
+    }
+}
+
 /*
   ===================================
     CIPHER
@@ -702,6 +899,321 @@ TEST(Cipher, AES_Unpadded)
     }
 }
 
+static void TestStreamAES(const char *name, const aes_mode mode, const uint32_t key, const uint32_t length, const uint32_t chunk)
+{
+    const uint8_t iv[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+    printf("> Testing %s streaming in chunks of %i bytes\n", name, chunk);
+    struct CipherImplementation* cipher = cipher_create_aes(vault, mode, key);
+
+    if (cipher != NULL) {
+        uint8_t* data = static_cast<uint8_t*>(malloc(length));
+        uint8_t* expected = static_cast<uint8_t*>(malloc(length + 16));
+        uint8_t* output = static_cast<uint8_t*>(malloc(length + 16));
+        uint8_t* input = static_cast<uint8_t*>(malloc(length + 32));
+
+        for (uint32_t index = 0; index < length; index++) {
+            data[index] = static_cast<uint8_t>(index * 7);
+        }
+
+        const int32_t expectedLength = cipher_encrypt(cipher, sizeof(iv), iv, length, data, (length + 16), expected);
+
+        struct CipherStreamImplementation* stream = cipher_stream_create(cipher, true, sizeof(iv), iv);
+        EXPECT_NE(stream != NULL, false);
+
+        if (stream != NULL) {
+            int32_t written = 0;
+
+            for (uint32_t offset = 0; offset < length; offset += chunk) {
+                written += cipher_stream_update(stream, MIN(chunk, (length - offset)), (data + offset), ((length + 16) - written), (output + written));
+            }
+            written += cipher_stream_final(stream, ((length + 16) - written), (output + written));
+            cipher_stream_destroy(stream);
+
+            EXPECT_EQ(written, expectedLength);
+            EXPECT_EQ(memcmp(output, expected, expectedLength), 0);
+        }
+
+        stream = cipher_stream_create(cipher, false, sizeof(iv), iv);
+        EXPECT_NE(stream != NULL, false);
+
+        if (stream != NULL) {
+            int32_t written = 0;
+
+            for (int32_t offset = 0; offset < expectedLength; offset += chunk) {
+                written += cipher_stream_update(stream, MIN(chunk, static_cast<uint32_t>(expectedLength - offset)), (expected + offset), ((length + 32) - written), (input + written));
+            }
+            written += cipher_stream_final(stream, ((length + 32) - written), (input + written));
+            cipher_stream_destroy(stream);
+
+            EXPECT_EQ(written, length);
+            EXPECT_EQ(memcmp(input, data, length), 0);
+        }
+
+        free(input);
+        free(output);
+        free(expected);
+        free(data);
+
+        cipher_destroy(cipher);
+    } else {
+        printf("  FATAL: Failed to create cryptor implementations, streaming test %s will be skipped\n", name);
+    }
+}
+
+TEST(Cipher, AES_Stream)
+{
+    const uint8_t key128[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11 };
+
+    uint32_t key128Id = vault_import(vault, sizeof(key128), key128);
+    EXPECT_NE(key128Id, 0);
+    if (key128Id != 0) {
+        TestStreamAES("128-bit AES/CBC", AES_MODE_CBC, key128Id, 100000, 777);
+        TestStreamAES("128-bit AES/CBC", AES_MODE_CBC, key128Id, 4096, 4096);
+        TestStreamAES("128-bit AES/CTR", AES_MODE_CTR, key128Id, 100000, 777);
+        TestStreamAES("128-bit AES/CTR", AES_MODE_CTR, key128Id, 100000, 1);
+        EXPECT_NE(vault_delete(vault, key128Id), false);
+    } else {
+        printf("  FATAL: Failed to store key to vault, streaming AES tests will be skipped\n");
+    }
+}
+
+static void TestAEAD(const char *name, struct CipherImplementation* cipher, const uint8_t iv[], const uint8_t ivLength,
+                     const uint8_t aad[], const uint32_t aadLength, const uint8_t data[], const uint32_t dataLength,
+                     const uint8_t expected[])
+{
+    printf("> Testing %s authenticated encryption of %i bytes with %i bytes of additional data\n", name, dataLength, aadLength);
+
+    if (cipher != NULL) {
+        uint8_t output[256];
+        uint8_t input[256];
+
+        int32_t length = cipher_encrypt_aead(cipher, ivLength, iv, aadLength, aad, dataLength, data, sizeof(output), output);
+        EXPECT_EQ(length, dataLength + 16);
+        if (expected != NULL) {
+            EXPECT_EQ(memcmp(output, expected, length), 0);
+        }
+
+        EXPECT_EQ(cipher_decrypt_aead(cipher, ivLength, iv, aadLength, aad, length, output, sizeof(input), input), dataLength);
+        EXPECT_EQ(memcmp(input, data, dataLength), 0);
+
+        /* The output only needs room for the plaintext, not for the tag. */
+        memset(input, 0, sizeof(input));
+        EXPECT_EQ(cipher_decrypt_aead(cipher, ivLength, iv, aadLength, aad, length, output, dataLength, input), dataLength);
+        EXPECT_EQ(memcmp(input, data, dataLength), 0);
+        EXPECT_EQ(cipher_decrypt_aead(cipher, ivLength, iv, aadLength, aad, length, output, (dataLength - 1), input), -static_cast<int32_t>(dataLength));
+
+        /* Neither different additional data nor a modified tag may pass. */
+        EXPECT_EQ(cipher_decrypt_aead(cipher, ivLength, iv, 0, NULL, length, output, sizeof(input), input), 0);
+        output[length - 1] ^= 0x01;
+        EXPECT_EQ(cipher_decrypt_aead(cipher, ivLength, iv, aadLength, aad, length, output, sizeof(input), input), 0);
+        output[length - 1] ^= 0x01;
+
+        /* Without additional data it works as a plain cipher, with the tag appended. */
+        length = cipher_encrypt(cipher, ivLength, iv, dataLength, data, sizeof(output), output);
+        EXPECT_EQ(length, dataLength + 16);
+        EXPECT_EQ(cipher_decrypt(cipher, ivLength, iv, length, output, sizeof(input), input), dataLength);
+        EXPECT_EQ(memcmp(input, data, dataLength), 0);
+        EXPECT_EQ(cipher_encrypt(cipher, ivLength, iv, dataLength, data, dataLength, output), -static_cast<int32_t>(dataLength + 16));
+
+        cipher_destroy(cipher);
+    } else {
+        printf("  FATAL: Failed to create cryptor implementations, AEAD test %s will be skipped\n", name);
+    }
+}
+
+TEST(Cipher, AEAD)
+{
+    /* GCM test case 4 from the GCM specification */
+    const uint8_t key128[] = { 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08 };
+    const uint8_t iv[] = { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88 };
+    const uint8_t aad[] = { 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+                            0xab, 0xad, 0xda, 0xd2 };
+    const uint8_t data[] = { 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+                             0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+                             0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+                             0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39 };
+    const uint8_t expected_AES_GCM_128[] = { 0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+                                             0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+                                             0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+                                             0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91,
+                                             0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47 };
+    const uint8_t key256[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11,
+                               0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11, 0x22 };
+
+    uint32_t key128Id = vault_import(vault, sizeof(key128), key128);
+    EXPECT_NE(key128Id, 0);
+    if (key128Id != 0) {
+        TestAEAD("128-bit AES/GCM", cipher_create_aes(vault, AES_MODE_GCM, key128Id), iv, sizeof(iv), aad, sizeof(aad), data, sizeof(data), expected_AES_GCM_128);
+        EXPECT_NE(vault_delete(vault, key128Id), false);
+    } else {
+        printf("  FATAL: Failed to store key to vault, 128-bit AEAD tests will be skipped\n");
+    }
+
+    uint32_t key256Id = vault_import(vault, sizeof(key256), key256);
+    EXPECT_NE(key256Id, 0);
+    if (key256Id != 0) {
+        TestAEAD("256-bit AES/GCM", cipher_create_aes(vault, AES_MODE_GCM, key256Id), iv, sizeof(iv), aad, sizeof(aad), data, sizeof(data), NULL);
+        TestAEAD("ChaCha20-Poly1305", cipher_create_chacha20_poly1305(vault, key256Id), iv, sizeof(iv), aad, sizeof(aad), data, sizeof(data), NULL);
+        EXPECT_NE(vault_delete(vault, key256Id), false);
+    } else {
+        printf("  FATAL: Failed to store key to vault, 256-bit AEAD tests will be skipped\n");
+    }
+}
+
+/*
+  ===================================
+    CONCURRENCY
+  ===================================
+*/
+
+static const uint8_t concurrencyThreads[] = { 1, 2, 4, 8 };
+static const uint32_t concurrencyIterations = 2000;
+
+/* Runs the operation on the given number of threads, returns the number of failed operations. */
+template <typename OPERATION>
+static uint32_t RunConcurrent(const uint8_t threads, OPERATION operation)
+{
+    std::atomic<uint32_t> failures(0);
+    std::vector<std::thread> workers;
+
+    const uint64_t start = Thunder::Core::Time::Now().Ticks();
+
+    for (uint8_t index = 0; index < threads; index++) {
+        workers.emplace_back([&]() {
+            for (uint32_t iteration = 0; iteration < concurrencyIterations; iteration++) {
+                if (operation() == false) {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    const uint64_t elapsed = (Thunder::Core::Time::Now().Ticks() - start);
+
+    printf("  %i threads: %llu op/s\n", threads,
+        static_cast<unsigned long long>((elapsed == 0) ? 0 : ((static_cast<uint64_t>(threads) * concurrencyIterations * 1000 * Thunder::Core::Time::TicksPerMillisecond) / elapsed)));
+
+    return (failures);
+}
+
+TEST(Concurrency, Cipher)
+{
+    const uint8_t key128[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x11 };
+    const uint8_t iv[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+    uint8_t data[1024];
+    uint8_t expected[1024 + 16];
+    memset(data, 0x74, sizeof(data));
+
+    uint32_t keyId = vault_import(vault, sizeof(key128), key128);
+    EXPECT_NE(keyId, 0);
+    if (keyId != 0) {
+        struct CipherImplementation* cipher = cipher_create_aes(vault, AES_MODE_CBC, keyId);
+
+        if (cipher != NULL) {
+            const int32_t expectedLength = cipher_encrypt(cipher, sizeof(iv), iv, sizeof(data), data, sizeof(expected), expected);
+            EXPECT_EQ(expectedLength, sizeof(expected));
+
+            printf("> Testing 128-bit AES/CBC on one cipher from multiple threads\n");
+
+            for (uint8_t index = 0; index < sizeof(concurrencyThreads); index++) {
+                EXPECT_EQ(RunConcurrent(concurrencyThreads[index], [&]() {
+                    uint8_t encrypted[1024 + 16];
+                    uint8_t decrypted[1024 + 16];
+
+                    return ((cipher_encrypt(cipher, sizeof(iv), iv, sizeof(data), data, sizeof(encrypted), encrypted) == expectedLength)
+                        && (memcmp(encrypted, expected, expectedLength) == 0)
+                        && (cipher_decrypt(cipher, sizeof(iv), iv, expectedLength, encrypted, sizeof(decrypted), decrypted) == sizeof(data))
+                        && (memcmp(decrypted, data, sizeof(data)) == 0));
+                }), 0);
+            }
+
+            cipher_destroy(cipher);
+        } else {
+            printf("  FATAL: Failed to create cipher implementation, concurrent cipher test will be skipped\n");
+        }
+
+        EXPECT_NE(vault_delete(vault, keyId), false);
+    } else {
+        printf("  FATAL: Failed to store key to vault, concurrent cipher test will be skipped\n");
+    }
+}
+
+TEST(Concurrency, HMAC)
+{
+    const uint8_t data[] = "Etaoin Shrldu";
+    const uint8_t password[] = "Thunder";
+
+    uint32_t secret = vault_import(vault, (sizeof(password) - 1), password);
+    EXPECT_NE(secret, 0);
+    if (secret != 0) {
+        struct HashImplementation* hash = hash_create_hmac(vault, HASH_TYPE_SHA256, secret);
+
+        if (hash != NULL) {
+            uint8_t expected[32];
+
+            hash_ingest(hash, (sizeof(data) - 1), data);
+            EXPECT_EQ(hash_calculate(hash, sizeof(expected), expected), sizeof(expected));
+
+            printf("> Testing HMAC SHA256 ingested on one thread and calculated on another\n");
+
+            uint8_t output[32];
+            uint8_t length = 0;
+            memset(output, 0, sizeof(output));
+
+            std::thread ingest([&]() {
+                hash_ingest(hash, (sizeof(data) - 1), data);
+            });
+            ingest.join();
+
+            std::thread calculate([&]() {
+                length = hash_calculate(hash, sizeof(output), output);
+            });
+            calculate.join();
+
+            EXPECT_EQ(length, sizeof(output));
+            EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+            printf("> Testing HMAC SHA256 on clones of one object from multiple threads\n");
+
+            for (uint8_t index = 0; index < sizeof(concurrencyThreads); index++) {
+                EXPECT_EQ(RunConcurrent(concurrencyThreads[index], [&]() {
+                    bool result = false;
+                    struct HashImplementation* clone = hash_clone(hash);
+
+                    if (clone != NULL) {
+                        uint8_t output[32];
+                        const uint16_t half = ((sizeof(data) - 1) / 2);
+
+                        hash_ingest(clone, half, data);
+                        hash_ingest(clone, ((sizeof(data) - 1) - half), (data + half));
+
+                        result = ((hash_calculate(clone, sizeof(output), output) == sizeof(output))
+                            && (memcmp(output, expected, sizeof(output)) == 0));
+
+                        hash_destroy(clone);
+                    }
+
+                    return (result);
+                }), 0);
+            }
+
+            hash_destroy(hash);
+        } else {
+            printf("  FATAL: Failed to create signing implementation, concurrent HMAC test will be skipped\n");
+        }
+
+        EXPECT_NE(vault_delete(vault, secret), false);
+    } else {
+        printf("  FATAL: Failed to store secret into vault, concurrent HMAC test will be skipped\n");
+    }
+}
+
 /*
   ===================================
 */
@@ -709,21 +1221,30 @@ TEST(Cipher, AES_Unpadded)
 int main(void)
 {
     CALL(Signing, Hash);
+    CALL(Random, Generate);
 
     vault = vault_instance(CRYPTOGRAPHY_VAULT_NETFLIX);
     if (vault != NULL) {
         CALL(Vault, Common);
         CALL(Vault, ImportExport);
         CALL(Vault, SetGet); // Will not work on Sage
+        CALL(Vault, Persistent);
 
         CALL(Signing, Hash);
         CALL(Signing, HMAC);
+        CALL(Signing, Reuse);
+        CALL(Signing, Batch);
 
         CALL(DH, Generate);
         CALL(DH, DeriveStandard); // Will not work on Sage
 
         CALL(Cipher, AES_Padded);
         CALL(Cipher, AES_Unpadded);
+        CALL(Cipher, AES_Stream);
+        CALL(Cipher, AEAD);
+
+        CALL(Concurrency, Cipher);
+        CALL(Concurrency, HMAC);
     }
 
     printf("TOTAL: %i tests; %i PASSED, %i FAILED\n", TotalTests, TotalTestsPassed, (TotalTests - TotalTestsPassed));
@@ -436,6 +436,63 @@ TEST_F(BasicTest, VaultHMACIngest65K)
     }
 }
 
+TEST_F(BasicTest, VaultHMACIngestCoalesced)
+{
+    static constexpr uint32_t TotalSize = (1024 * 1024);
+
+    ASSERT_EQ(controller.ActivatePlugin(TestData::plugin), Thunder::Core::ERROR_NONE);
+    ASSERT_TRUE(controller.IsPluginActive(TestData::plugin));
+    ASSERT_NE(nullptr, cryptography);
+
+    Thunder::Exchange::IVault* vault = cryptography->Vault(Thunder::Exchange::CRYPTOGRAPHY_VAULT_PLATFORM);
+
+    ASSERT_NE(nullptr, vault);
+
+    uint32_t keyId = vault->Import(sizeof(TestData::cipherkey), TestData::cipherkey);
+
+    // Feed the same data in small pieces, once with every piece a round trip
+    // and once collected by the client, the digests must be the same.
+    uint8_t hashBuffer[2][20];
+    uint64_t duration[2];
+    const char* const bufferSize[2] = { "0", "8192" };
+
+    for (uint8_t run = 0; run < 2; run++) {
+        setenv("CRYPTOGRAPHY_INGEST_BUFFER", bufferSize[run], 1);
+
+        Thunder::Exchange::IHash* iface = vault->HMAC(Thunder::Exchange::SHA1, keyId);
+
+        ASSERT_NE(nullptr, iface);
+
+        uint32_t totalSize(0);
+        const uint64_t start = Thunder::Core::Time::Now().Ticks();
+
+        while (totalSize < TotalSize) {
+            const uint32_t size = iface->Ingest(sizeof(TestData::data), reinterpret_cast<const uint8_t*>(TestData::data));
+            ASSERT_EQ(size, sizeof(TestData::data));
+            totalSize += size;
+        }
+
+        memset(hashBuffer[run], 0, sizeof(hashBuffer[run]));
+        EXPECT_EQ(iface->Calculate(sizeof(hashBuffer[run]), hashBuffer[run]), Thunder::Exchange::SHA1);
+
+        duration[run] = std::max(Thunder::Core::Time::Now().Ticks() - start, static_cast<uint64_t>(1));
+
+        iface->Release();
+    }
+
+    unsetenv("CRYPTOGRAPHY_INGEST_BUFFER");
+
+    EXPECT_EQ(memcmp(hashBuffer[0], hashBuffer[1], sizeof(hashBuffer[0])), 0);
+
+    printf("Ingest of %u bytes in pieces of %u bytes: %.1f MB/s per call, %.1f MB/s coalesced\n",
+        TotalSize, static_cast<uint32_t>(sizeof(TestData::data)),
+        ((static_cast<double>(TotalSize) * Thunder::Core::Time::TicksPerMillisecond * 1000) / (duration[0] * 1024.0 * 1024.0)),
+        ((static_cast<double>(TotalSize) * Thunder::Core::Time::TicksPerMillisecond * 1000) / (duration[1] * 1024.0 * 1024.0)));
+
+    vault->Delete(keyId);
+    vault->Release();
+}
+
 TEST_F(BasicTest, VaultAES)
 {
     ASSERT_EQ(controller.ActivatePlugin(TestData::plugin), Thunder::Core::ERROR_NONE);
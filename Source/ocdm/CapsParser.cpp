@@ -19,18 +19,68 @@
 
 #include "CapsParser.h"
 
+#include <algorithm>
+#include <cctype>
+
 static constexpr TCHAR StartingCharacter = ')';
 static constexpr TCHAR EndingCharacter   = ',';
+static constexpr TCHAR AssignCharacter   = '=';
 static constexpr TCHAR WidthTag[]        = _T("width");
 static constexpr TCHAR HeightTag[]       = _T("height");
 static constexpr TCHAR MediaTag[]        = _T("original-media-type");
+static constexpr TCHAR VideoMarker[]     = _T("video");
+static constexpr TCHAR AudioMarker[]     = _T("audio");
+
+namespace {
+
+    // A range in the caps string, never copied out of it.
+    struct Fragment {
+        const TCHAR* Data;
+        uint16_t Length;
+
+        bool IsSet() const {
+            return (Data != nullptr);
+        }
+        bool Contains(const TCHAR marker[], const uint16_t markerLength) const {
+            return (std::search(Data, Data + Length, marker, marker + markerLength) != (Data + Length));
+        }
+    };
+
+    // Fields look like "name=(type)value", if the field is the one named by
+    // tag, the value is everything after the type.
+    template <uint16_t TAGLENGTH>
+    void Match(const TCHAR* field, const TCHAR* end, const TCHAR (&tag)[TAGLENGTH], Fragment& value)
+    {
+        constexpr uint16_t length = TAGLENGTH - 1;
+
+        if ((value.IsSet() == false) && ((end - field) > static_cast<ptrdiff_t>(length)) && (::memcmp(field, tag, length) == 0) && (field[length] == AssignCharacter)) {
+            const TCHAR* start = std::find(field + length, end, StartingCharacter);
+
+            start = (start != end ? start + 1 : field + length + 1);
+
+            value.Data = start;
+            value.Length = static_cast<uint16_t>(end - start);
+        }
+    }
+
+    uint16_t Number(const Fragment& value)
+    {
+        uint32_t result = 0;
+
+        for (uint16_t index = 0; (index < value.Length) && (::isdigit(static_cast<unsigned char>(value.Data[index]))) && (result <= 0xFFFF); index++) {
+            result = (result * 10) + (value.Data[index] - '0');
+        }
+
+        return (result <= 0xFFFF ? static_cast<uint16_t>(result) : 0);
+    }
+
+}
 
 namespace Thunder {
     namespace Plugin {
 
         CapsParser::CapsParser() 
-            : _lastHash(0)
-            , _mediaType(CDMi::Unknown)
+            : _mediaType(CDMi::Unknown)
             , _width(0)
             , _height(0) {
         }
@@ -41,81 +91,53 @@ namespace Thunder {
         void CapsParser::Parse(const uint8_t* info, const uint16_t infoLength) /* override */ 
         {
             if(infoLength > 0) {
-                std::string infoStr(reinterpret_cast<const char*>(info), infoLength);
-
-                std::hash<::string> hash_fn;
-                size_t info_hash = hash_fn(infoStr);
-                if(_lastHash != info_hash) {
-                    _lastHash = info_hash;
-
-                    // Parse the data
-                    std::string result = FindMarker(infoStr, MediaTag);
-                    if(!result.empty()) {
-                        if(result.find("video") != ::string::npos) {
-                            _mediaType = CDMi::Video;
-                        }
-                        else if(result.find("audio") != ::string::npos) {
-                            _mediaType = CDMi::Audio;
-                        }
-                        else {
-                            TRACE(Trace::Error, (Core::Format(_T("Found and unknown media type %s\n"), result.c_str())));
-                            _mediaType = CDMi::Unknown;
-                        }
-                    }
-                    else {
-                        TRACE(Trace::Warning, (_T("No result for media type")));
-                    }
+                const TCHAR* field = reinterpret_cast<const TCHAR*>(info);
+                const TCHAR* const end = field + infoLength;
 
-                    if(_mediaType == CDMi::Video) {
+                Fragment media = { nullptr, 0 };
+                Fragment width = { nullptr, 0 };
+                Fragment height = { nullptr, 0 };
 
-                        result = FindMarker(infoStr, WidthTag);
+                while (field < end) {
+                    const TCHAR* next = std::find(field, end, EndingCharacter);
 
-                        if (result.length() > 0) {
-                            _width = Core::NumberType<uint16_t>(result.c_str(), result.length(), NumberBase::BASE_DECIMAL);
-                        }
-                        else {
-                            _width = 0;
-                            TRACE(Trace::Warning, (_T("No result for width")));
-                        }
+                    while ((field < next) && (::isspace(static_cast<unsigned char>(*field)))) {
+                        field++;
+                    }
 
-                        result = FindMarker(infoStr, HeightTag);
+                    Match(field, next, MediaTag, media);
+                    Match(field, next, WidthTag, width);
+                    Match(field, next, HeightTag, height);
 
-                        if (result.length() > 0) {
-                            _height = Core::NumberType<uint16_t>(result.c_str(), result.length(), NumberBase::BASE_DECIMAL);
-                        }
-                        else {
-                            _height = 0;
-                            TRACE(Trace::Warning, (_T("No result for height")));
-                        }
+                    field = (next != end ? next + 1 : end);
+                }
+
+                if(media.IsSet() == true) {
+                    if(media.Contains(VideoMarker, sizeof(VideoMarker) - 1) == true) {
+                        _mediaType = CDMi::Video;
+                    }
+                    else if(media.Contains(AudioMarker, sizeof(AudioMarker) - 1) == true) {
+                        _mediaType = CDMi::Audio;
                     }
                     else {
-                        // Audio
-                        _width  = 0;
-                        _height = 0;
+                        TRACE(Trace::Error, (_T("Found and unknown media type %.*s"), media.Length, media.Data));
+                        _mediaType = CDMi::Unknown;
                     }
                 }
-            }
-        }
+                else {
+                    TRACE(Trace::Warning, (_T("No result for media type")));
+                }
 
-        std::string CapsParser::FindMarker(const std::string& data, const TCHAR tag[]) const
-        {
-            std::string retVal;
-
-            size_t found = data.find(tag);
-            TRACE(Trace::Warning, (Core::Format(_T("Found tag <%s> in <%s> at location %zu"), tag, data.c_str(), found)));
-            if(found != ::string::npos) {
-                // Found the marker
-                // Find the end of the gst caps type identifier
-                size_t start = data.find(StartingCharacter, found) + 1;  // step over the ")"
-                size_t end = data.find(EndingCharacter, start);
-                if(end == ::string::npos) {
-                    // Went past the end of the string
-                    end = data.length();
+                if(_mediaType == CDMi::Video) {
+                    _width = (width.IsSet() == true ? Number(width) : 0);
+                    _height = (height.IsSet() == true ? Number(height) : 0);
+                }
+                else {
+                    // Audio
+                    _width  = 0;
+                    _height = 0;
                 }
-                retVal = data.substr(start, end - start);
-                TRACE(Trace::Warning, (Core::Format(_T("Found substr <%s>"), retVal.c_str())));
             }
-            return retVal;
         }
     }
 }
@@ -26,7 +26,7 @@
 namespace Thunder {
     namespace Plugin {
 
-        class CapsParser {
+        class EXTERNAL CapsParser {
         public:
             CapsParser(const CapsParser&) = delete;
             CapsParser& operator= (const CapsParser&) = delete;
@@ -35,6 +35,7 @@ namespace Thunder {
             ~CapsParser();
 
         public:
+            // Single pass over the caps string, nothing is copied or allocated.
             void Parse(const uint8_t* info, const uint16_t infoLength); 
 
             uint16_t GetHeight() const { 
@@ -48,11 +49,6 @@ namespace Thunder {
             } 
         
         private:
-            std::string FindMarker(const std::string& data, const TCHAR* tag) const;
-
-        private:
-            size_t _lastHash;
-
             CDMi::MediaType _mediaType;
             uint16_t _width;
             uint16_t _height;
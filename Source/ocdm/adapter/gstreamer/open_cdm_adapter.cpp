@@ -24,6 +24,11 @@
 #include "CapsParser.h"
 #include "open_cdm_adapter.h"
 
+#include <atomic>
+
+// The SampleInfo subsample count is an uint8_t.
+static constexpr uint32_t MaxSubSamples = 255;
+
 inline bool mappedBuffer(GstBuffer *buffer, bool writable, uint8_t **data, uint32_t *size)
 {
     GstMapInfo map;
@@ -39,6 +44,317 @@ inline bool mappedBuffer(GstBuffer *buffer, bool writable, uint8_t **data, uint3
     return true;
 }
 
+namespace {
+
+    // Per session scratch space for the sample metadata. The subsample table
+    // grows to the largest one seen and is reused from there on, so a steady
+    // state decrypt does not touch the heap. Every heap allocation done on
+    // behalf of a decrypt is counted.
+    class Scratch {
+    public:
+        Scratch(const Scratch&) = delete;
+        Scratch& operator=(const Scratch&) = delete;
+
+        Scratch()
+            : _lock()
+            , _subSamples(nullptr)
+            , _capacity(0)
+            , _sampleInfos(nullptr)
+            , _sampleInfoCapacity(0)
+            , _batch(nullptr)
+            , _batchCapacity(0)
+            , _allocations(0)
+            , _sampleInfo()
+            , _properties()
+            , _caps(nullptr)
+            , _hasProperties(false)
+        {
+        }
+        ~Scratch()
+        {
+            if (_caps != nullptr) {
+                gst_caps_unref(_caps);
+            }
+            free(_subSamples);
+            free(_sampleInfos);
+            free(_batch);
+        }
+
+    public:
+        void Lock()
+        {
+            _lock.Lock();
+        }
+        void Unlock()
+        {
+            _lock.Unlock();
+        }
+        SubSampleInfo* SubSamples(const uint32_t count)
+        {
+            return (Grow(_subSamples, _capacity, count));
+        }
+        SampleInfo* SampleInfos(const uint32_t count)
+        {
+            return (Grow(_sampleInfos, _sampleInfoCapacity, count));
+        }
+        DecryptSample* Batch(const uint32_t count)
+        {
+            return (Grow(_batch, _batchCapacity, count));
+        }
+        void Allocated()
+        {
+            _allocations++;
+        }
+        uint64_t Allocations() const
+        {
+            return (_allocations);
+        }
+        SampleInfo& Sample()
+        {
+            return (_sampleInfo);
+        }
+        MediaProperties& Properties()
+        {
+            return (_properties);
+        }
+        // The properties belong to these caps. A reference is kept, so the
+        // caps can not be freed and another one show up at the same address.
+        bool IsCaps(const GstCaps* caps) const
+        {
+            return (caps == _caps);
+        }
+        void Caps(GstCaps* caps, const bool hasProperties)
+        {
+            if (_caps != nullptr) {
+                gst_caps_unref(_caps);
+            }
+            _caps = (caps != nullptr ? gst_caps_ref(caps) : nullptr);
+            _hasProperties = hasProperties;
+        }
+        bool HasProperties() const
+        {
+            return (_hasProperties);
+        }
+
+    private:
+        template <typename TYPE>
+        TYPE* Grow(TYPE*& storage, uint32_t& capacity, const uint32_t count)
+        {
+            if (count > capacity) {
+                TYPE* grown = reinterpret_cast<TYPE*>(realloc(storage, count * sizeof(TYPE)));
+
+                if (grown != nullptr) {
+                    storage = grown;
+                    capacity = count;
+                    _allocations++;
+                }
+            }
+
+            return (count <= capacity ? storage : nullptr);
+        }
+
+    private:
+        Thunder::Core::CriticalSection _lock;
+        SubSampleInfo* _subSamples;
+        uint32_t _capacity;
+        SampleInfo* _sampleInfos;
+        uint32_t _sampleInfoCapacity;
+        DecryptSample* _batch;
+        uint32_t _batchCapacity;
+        std::atomic<uint64_t> _allocations;
+        SampleInfo _sampleInfo;
+        MediaProperties _properties;
+        GstCaps* _caps;
+        bool _hasProperties;
+    };
+
+    uint32_t SubSampleCount(const GstProtectionMeta* protectionMeta)
+    {
+        unsigned subSampleCount = 0;
+
+        if (!gst_structure_get_uint(protectionMeta->info, "subsample_count", &subSampleCount)) {
+            TRACE_L1("No Subsample Count.");
+        }
+
+        return (subSampleCount);
+    }
+
+    // Entries a sample takes in the subsample table of a batch. Counts that
+    // Describe() rejects take none, so they can not push the table size or
+    // the offsets into it past what was allocated.
+    uint32_t BatchSubSampleCount(const GstProtectionMeta* protectionMeta)
+    {
+        const uint32_t subSampleCount = (protectionMeta != nullptr ? SubSampleCount(protectionMeta) : 0);
+
+        return (subSampleCount > MaxSubSamples ? 0 : subSampleCount);
+    }
+
+    // Fills in the sample info from the protection meta data, the subsample
+    // mapping is stored in subSamples, which must hold SubSampleCount() entries.
+    bool Describe(const GstProtectionMeta* protectionMeta, SampleInfo& sampleInfo, SubSampleInfo subSamples[])
+    {
+        const GValue* value;
+
+        //Get Subsample mapping
+        const uint32_t subSampleCount = SubSampleCount(protectionMeta);
+
+        sampleInfo.subSample = nullptr;
+        sampleInfo.subSampleCount = 0;
+
+        if (subSampleCount > MaxSubSamples) {
+            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Too many subsamples [%d].", subSampleCount);
+            return (false);
+        } else if (subSampleCount > 0) {
+            value = gst_structure_get_value(protectionMeta->info, "subsamples");
+            if (!value) {
+                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: No subsample buffer.");
+                return (false);
+            }
+            GstBuffer* subSample = gst_value_get_buffer(value);
+            uint8_t *mappedSubSample = nullptr;
+            uint32_t mappedSubSampleSize = 0;
+            if (subSample != nullptr && mappedBuffer(subSample, false, &mappedSubSample, &mappedSubSampleSize) == false) {
+                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid subsample buffer.");
+                return (false);
+            }
+
+            GstByteReader reader;
+            gst_byte_reader_init(&reader, mappedSubSample, mappedSubSampleSize);
+            for (unsigned int position = 0; position < subSampleCount; position++) {
+
+                if ((gst_byte_reader_get_uint16_be(&reader, &subSamples[position].clear_bytes) == FALSE)
+                    || (gst_byte_reader_get_uint32_be(&reader, &subSamples[position].encrypted_bytes) == FALSE)) {
+                    TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Subsample buffer too short.");
+                    return (false);
+                }
+            }
+
+            sampleInfo.subSample = subSamples;
+            sampleInfo.subSampleCount = static_cast<uint8_t>(subSampleCount);
+        }
+
+        //Get IV
+        value = gst_structure_get_value(protectionMeta->info, "iv");
+        if (!value) {
+            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing IV buffer.");
+            return (false);
+        }
+        GstBuffer* IV = gst_value_get_buffer(value);
+        uint8_t *mappedIV = nullptr;
+        uint32_t mappedIVSize = 0;
+        if (mappedBuffer(IV, false, &mappedIV, &mappedIVSize) == false) {
+            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid IV buffer.");
+            return (false);
+        }
+
+        //Get Key ID
+        value = gst_structure_get_value(protectionMeta->info, "kid");
+        if (!value) {
+            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing KeyId buffer.");
+            return (false);
+        }
+        GstBuffer* keyID = gst_value_get_buffer(value);
+        uint8_t *mappedKeyID = nullptr;
+        uint32_t mappedKeyIDSize = 0;
+        if (keyID != nullptr && mappedBuffer(keyID, false, &mappedKeyID, &mappedKeyIDSize) == false) {
+            TRACE_L1("Invalid keyID buffer.");
+            return (false);
+        }
+
+        //Get Encryption Scheme and Pattern
+        EncryptionScheme encScheme = AesCtr_Cenc;
+        EncryptionPattern pattern = {0, 0};
+        const char* cipherModeBuf = gst_structure_get_string(protectionMeta->info, "cipher-mode");
+        if(g_strcmp0(cipherModeBuf,"cbcs") == 0) {
+            encScheme = AesCbc_Cbcs;
+        } else if (gst_structure_has_name(protectionMeta->info, "application/x-cbcs")) {
+            encScheme = AesCbc_Cbcs;
+        }
+        gst_structure_get_uint(protectionMeta->info, "crypt_byte_block", &pattern.encrypted_blocks);
+        gst_structure_get_uint(protectionMeta->info, "skip_byte_block", &pattern.clear_blocks);
+
+        sampleInfo.scheme = encScheme;
+        sampleInfo.pattern.clear_blocks = pattern.clear_blocks;
+        sampleInfo.pattern.encrypted_blocks = pattern.encrypted_blocks;
+        sampleInfo.iv = mappedIV;
+        sampleInfo.ivLength = static_cast<uint8_t>(mappedIVSize);
+        sampleInfo.keyId = mappedKeyID;
+        sampleInfo.keyIdLength = static_cast<uint8_t>(mappedKeyIDSize);
+
+        return (true);
+    }
+
+    //Get Stream Properties from GstCaps, only parsed if the caps changed
+    bool StreamProperties(GstCaps* caps, MediaProperties& streamProperties, Scratch& scratch)
+    {
+        bool result = false;
+
+        if (scratch.IsCaps(caps) == true) {
+            result = scratch.HasProperties();
+        } else if (caps != nullptr) {
+            gchar *capsStr = gst_caps_to_string (caps);
+            scratch.Allocated();
+            if (capsStr != nullptr) {
+                Thunder::Plugin::CapsParser capsParser;
+                capsParser.Parse(reinterpret_cast<const uint8_t*>(capsStr), strlen(capsStr));
+                streamProperties.height = capsParser.GetHeight();
+                streamProperties.width = capsParser.GetWidth();
+                switch (capsParser.GetMediaType()) {
+                    case CDMi::MediaType::Video:
+                        streamProperties.media_type = MediaType_Video;
+                    break;
+
+                    case CDMi::MediaType::Audio:
+                        streamProperties.media_type = MediaType_Audio;
+                    break;
+
+                    case CDMi::MediaType::Data:
+                        streamProperties.media_type = MediaType_Data;
+                    break;
+
+                    default:
+                        streamProperties.media_type = MediaType_Unknown;
+                    break;
+                }
+                result = true;
+                g_free(capsStr);
+            } else {
+                TRACE_L1("Could not convert caps to string");
+            }
+
+            scratch.Caps(caps, result);
+        }
+
+        return (result);
+    }
+
+}
+
+uint32_t opencdm_construct_session_private(struct OpenCDMSession*, void* &pvtData)
+{
+    pvtData = new Scratch();
+    return (0);
+}
+
+uint32_t opencdm_destruct_session_private(struct OpenCDMSession*, void* &pvtData)
+{
+    delete reinterpret_cast<Scratch*>(pvtData);
+    pvtData = nullptr;
+    return (0);
+}
+
+uint64_t opencdm_gstreamer_session_allocations(struct OpenCDMSession* session)
+{
+    uint64_t result = 0;
+    const Scratch* scratch = (session != nullptr ? reinterpret_cast<const Scratch*>(opencdm_session_private_data(session)) : nullptr);
+
+    if (scratch != nullptr) {
+        result = scratch->Allocations();
+    }
+
+    return (result);
+}
+
 OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, GstBuffer* buffer, GstBuffer* subSampleBuffer, const uint32_t subSampleCount,
                                                GstBuffer* IV, GstBuffer* keyID, uint32_t initWithLast15)
 {
@@ -107,51 +423,46 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
                 gst_buffer_unmap(buffer, &dataMap);
                 return (ERROR_INVALID_DECRYPT_BUFFER);
             }
-            uint8_t *mappedSubSample = reinterpret_cast<uint8_t* >(sampleMap.data);
-            uint32_t mappedSubSampleSize = static_cast<uint32_t >(sampleMap.size);
-            GstByteReader* reader = gst_byte_reader_new(mappedSubSample, mappedSubSampleSize);
-            uint16_t inClear = 0;
-            uint32_t inEncrypted = 0;
-            uint32_t totalEncrypted = 0;
-            for (unsigned int position = 0; position < subSampleCount; position++) {
-
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-                totalEncrypted += inEncrypted;
-            }
-            gst_byte_reader_set_pos(reader, 0);
-
-            uint8_t* encryptedData = reinterpret_cast<uint8_t*>(malloc(totalEncrypted));
-            uint8_t* encryptedDataIter = encryptedData;
-
-            uint32_t index = 0;
-            for (unsigned int position = 0; position < subSampleCount; position++) {
-
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-
-                memcpy(encryptedDataIter, mappedData + index + inClear, inEncrypted);
-                index += inClear + inEncrypted;
-                encryptedDataIter += inEncrypted;
+            // Hand the subsample map over to the DRM implementation, so it works on
+            // the original buffer layout. One pass over the table, straight into a
+            // stack array: no heap allocation and no gather/scatter of the sample.
+            SubSampleInfo subSamples[MaxSubSamples];
+            GstByteReader reader;
+            // 64 bits, so a hostile map can not wrap the sum past the check below.
+            uint64_t total = 0;
+            bool valid = (subSampleCount <= MaxSubSamples);
+
+            gst_byte_reader_init(&reader, reinterpret_cast<const guint8*>(sampleMap.data), static_cast<guint>(sampleMap.size));
+
+            for (uint32_t position = 0; (valid == true) && (position < subSampleCount); position++) {
+                valid = (gst_byte_reader_get_uint16_be(&reader, &subSamples[position].clear_bytes) == TRUE)
+                     && (gst_byte_reader_get_uint32_be(&reader, &subSamples[position].encrypted_bytes) == TRUE);
+
+                if (valid == true) {
+                    total += static_cast<uint64_t>(subSamples[position].clear_bytes) + subSamples[position].encrypted_bytes;
+                }
             }
-            gst_byte_reader_set_pos(reader, 0);
-
 
-            result = opencdm_session_decrypt(session, encryptedData, totalEncrypted, encScheme, pattern, mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
-            // Re-build sub-sample data.
-            index = 0;
-            unsigned total = 0;
-            for (uint32_t position = 0; position < subSampleCount; position++) {
-                gst_byte_reader_get_uint16_be(reader, &inClear);
-                gst_byte_reader_get_uint32_be(reader, &inEncrypted);
-
-                memcpy(mappedData + total + inClear, encryptedData + index, inEncrypted);
-                index += inEncrypted;
-                total += inClear + inEncrypted;
+            if ((valid == false) || (total > mappedDataSize)) {
+                TRACE_L1(_T("Invalid subsample map."));
+                result = ERROR_INVALID_DECRYPT_BUFFER;
+            } else if (mappedDataSize > 0) {
+                SampleInfo sampleInfo;
+                sampleInfo.subSample = subSamples;
+                sampleInfo.subSampleCount = static_cast<uint8_t>(subSampleCount);
+                sampleInfo.scheme = encScheme;
+                sampleInfo.pattern.clear_blocks = pattern.clear_blocks;
+                sampleInfo.pattern.encrypted_blocks = pattern.encrypted_blocks;
+                sampleInfo.iv = mappedIV;
+                sampleInfo.ivLength = static_cast<uint8_t>(mappedIVSize);
+                sampleInfo.keyId = mappedKeyID;
+                sampleInfo.keyIdLength = static_cast<uint8_t>(mappedKeyIDSize);
+
+                result = opencdm_session_decrypt_subsamples(session, mappedData, mappedDataSize, &sampleInfo, initWithLast15, nullptr);
+            } else {
+                result = ERROR_NONE;
             }
 
-            gst_byte_reader_free(reader);
-            free(encryptedData);
             gst_buffer_unmap(subSampleBuffer, &sampleMap);
         } else {
             result = opencdm_session_decrypt(session, mappedData, mappedDataSize, encScheme, pattern, mappedIV, mappedIVSize, mappedKeyID, mappedKeyIDSize, initWithLast15);
@@ -177,164 +488,127 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
 
         uint8_t *mappedData = nullptr;
         uint32_t mappedDataSize = 0;
+        GstProtectionMeta* protectionMeta = nullptr;
+
         if (mappedBuffer(buffer, true, &mappedData, &mappedDataSize) == false) {
 
             TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid buffer.");
             result = ERROR_INVALID_DECRYPT_BUFFER;
-            goto exit;
         }
-
         //Check if Protection Metadata is available in Buffer
-        GstProtectionMeta* protectionMeta = reinterpret_cast<GstProtectionMeta*>(gst_buffer_get_protection_meta(buffer));
-        if (protectionMeta != nullptr) {
-            const GValue* value;
-
-            //Get Subsample mapping
-            unsigned subSampleCount = 0;
-            GstBuffer* subSample = nullptr;
-            if (!gst_structure_get_uint(protectionMeta->info, "subsample_count", &subSampleCount)) {
-                TRACE_L1("No Subsample Count.");
-            }
-            uint8_t *mappedSubSample = nullptr;
-            uint32_t mappedSubSampleSize = 0;
-
-            if (subSampleCount > 0) {
-                value = gst_structure_get_value(protectionMeta->info, "subsamples");
-                if (!value) {
-                    TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: No subsample buffer.");
-                    result = ERROR_INVALID_DECRYPT_BUFFER;
-                    goto exit;
-                }
-                subSample = gst_value_get_buffer(value);
-                if (subSample != nullptr && mappedBuffer(subSample, false, &mappedSubSample, &mappedSubSampleSize) == false) {
-                    TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid subsample buffer.");
-                    result = ERROR_INVALID_DECRYPT_BUFFER;
-                    goto exit;
-                }
-                ASSERT(mappedSubSampleSize==subSampleCount);
-            }
+        else if ((protectionMeta = reinterpret_cast<GstProtectionMeta*>(gst_buffer_get_protection_meta(buffer))) == nullptr) {
 
-            //Get IV
-            value = gst_structure_get_value(protectionMeta->info, "iv");
-            if (!value) {
-                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing IV buffer.");
-                result = ERROR_INVALID_DECRYPT_BUFFER;
-                goto exit;
-            }
-            GstBuffer* IV = gst_value_get_buffer(value);
-            uint8_t *mappedIV = nullptr;    //Set the Encryption Scheme and Pattern to defaults.
-            uint32_t mappedIVSize = 0;
-            if (mappedBuffer(IV, false, &mappedIV, &mappedIVSize) == false) {
-                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Invalid IV buffer.");
+            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing Protection Metadata.");
+            result = ERROR_INVALID_DECRYPT_BUFFER;
+        } else {
+            //Sessions without private data (no session private hooks) get a
+            //scratch that only lives for this sample.
+            Scratch localScratch;
+            Scratch* sessionScratch = reinterpret_cast<Scratch*>(opencdm_session_private_data(session));
+            Scratch& scratch = (sessionScratch != nullptr ? *sessionScratch : localScratch);
+
+            scratch.Lock();
+
+            const uint32_t subSampleCount = SubSampleCount(protectionMeta);
+            SubSampleInfo* subSamples = scratch.SubSamples(subSampleCount);
+            SampleInfo& sampleInfo = scratch.Sample();
+            MediaProperties& streamProperties = scratch.Properties();
+
+            if ((subSampleCount > 0) && (subSamples == nullptr)) {
+                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Out of memory for the subsample map.");
+                result = ERROR_OUT_OF_MEMORY;
+            } else if (Describe(protectionMeta, sampleInfo, subSamples) == false) {
                 result = ERROR_INVALID_DECRYPT_BUFFER;
-                goto exit;
+            } else {
+                result = opencdm_session_decrypt_v2(session,
+                                                    mappedData,
+                                                    mappedDataSize,
+                                                    &sampleInfo,
+                                                    (StreamProperties(caps, streamProperties, scratch) == true ? &streamProperties : nullptr));
             }
 
-            //Get Key ID
-            value = gst_structure_get_value(protectionMeta->info, "kid");
-            if (!value) {
-                TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing KeyId buffer.");
-                result = ERROR_INVALID_DECRYPT_BUFFER;
-                goto exit;
-            }
-            GstBuffer* keyID = gst_value_get_buffer(value);
-            uint8_t *mappedKeyID = nullptr;
-            uint32_t mappedKeyIDSize = 0;
-            if (keyID != nullptr && mappedBuffer(keyID, false, &mappedKeyID, &mappedKeyIDSize) == false) {
-                TRACE_L1("Invalid keyID buffer.");
-                result = ERROR_INVALID_DECRYPT_BUFFER;
-                goto exit;
-            }
+            scratch.Unlock();
+        }
+    }
 
-            //Get Encryption Scheme and Pattern
-            EncryptionScheme encScheme = AesCtr_Cenc;
-            EncryptionPattern pattern = {0, 0};
-            const char* cipherModeBuf = gst_structure_get_string(protectionMeta->info, "cipher-mode");
-            if(g_strcmp0(cipherModeBuf,"cbcs") == 0) {
-                encScheme = AesCbc_Cbcs;
-            } else if (gst_structure_has_name(protectionMeta->info, "application/x-cbcs")) {
-                encScheme = AesCbc_Cbcs;
+    return (result);
+}
+
+OpenCDMError opencdm_gstreamer_session_decrypt_batch(struct OpenCDMSession* session, GstBuffer* buffers[], const uint32_t count, GstCaps* caps, OpenCDMError results[]) {
+
+    OpenCDMError result (ERROR_INVALID_SESSION);
+
+    if (session != nullptr) {
+
+        if ((count > 0) && ((buffers == nullptr) || (results == nullptr))) {
+            result = ERROR_INVALID_ARG;
+        } else {
+            Scratch localScratch;
+            Scratch* sessionScratch = reinterpret_cast<Scratch*>(opencdm_session_private_data(session));
+            Scratch& scratch = (sessionScratch != nullptr ? *sessionScratch : localScratch);
+
+            scratch.Lock();
+
+            // All subsample maps of the batch go into one table.
+            uint32_t total = 0;
+            for (uint32_t index = 0; index < count; index++) {
+                GstProtectionMeta* protectionMeta = (buffers[index] != nullptr ? reinterpret_cast<GstProtectionMeta*>(gst_buffer_get_protection_meta(buffers[index])) : nullptr);
+                total += BatchSubSampleCount(protectionMeta);
             }
-            gst_structure_get_uint(protectionMeta->info, "crypt_byte_block", &pattern.encrypted_blocks);
-            gst_structure_get_uint(protectionMeta->info, "skip_byte_block", &pattern.clear_blocks);
 
-            //Create a SubSampleInfo Array with mapping
-            SubSampleInfo * subSampleInfoPtr = nullptr;
-            if (subSample != nullptr) {
-                GstByteReader* reader = gst_byte_reader_new(mappedSubSample, mappedSubSampleSize);
-                subSampleInfoPtr = reinterpret_cast<SubSampleInfo*>(malloc(subSampleCount * sizeof(SubSampleInfo)));
-                for (unsigned int position = 0; position < subSampleCount; position++) {
+            DecryptSample* samples = scratch.Batch(count);
+            SampleInfo* sampleInfos = scratch.SampleInfos(count);
+            SubSampleInfo* subSamples = scratch.SubSamples(total);
+
+            if ((count > 0) && ((samples == nullptr) || (sampleInfos == nullptr) || ((total > 0) && (subSamples == nullptr)))) {
+                TRACE_L1("opencdm_gstreamer_session_decrypt_batch: Out of memory for the batch.");
+                result = ERROR_OUT_OF_MEMORY;
 
-                    gst_byte_reader_get_uint16_be(reader, &subSampleInfoPtr[position].clear_bytes);
-                    gst_byte_reader_get_uint32_be(reader, &subSampleInfoPtr[position].encrypted_bytes);
+                for (uint32_t index = 0; index < count; index++) {
+                    results[index] = result;
                 }
-                gst_byte_reader_set_pos(reader, 0);
-                gst_byte_reader_free(reader);
-            }
+            } else {
+                MediaProperties& streamProperties = scratch.Properties();
+                const MediaProperties* properties = (StreamProperties(caps, streamProperties, scratch) == true ? &streamProperties : nullptr);
+                uint32_t offset = 0;
+
+                for (uint32_t index = 0; index < count; index++) {
+                    DecryptSample& sample = samples[index];
+                    GstProtectionMeta* protectionMeta = (buffers[index] != nullptr ? reinterpret_cast<GstProtectionMeta*>(gst_buffer_get_protection_meta(buffers[index])) : nullptr);
+
+                    // Samples that can not be described stay in the batch
+                    // without data, they are reported as invalid afterwards.
+                    sample.encrypted = nullptr;
+                    sample.encryptedLength = 0;
+                    sample.sampleInfo = nullptr;
+                    sample.streamProperties = properties;
+
+                    if (protectionMeta == nullptr) {
+                        TRACE_L1("opencdm_gstreamer_session_decrypt_batch: Missing Protection Metadata.");
+                    } else {
+                        if ((Describe(protectionMeta, sampleInfos[index], (subSamples != nullptr ? subSamples + offset : nullptr)) == true)
+                            && (mappedBuffer(buffers[index], true, &sample.encrypted, &sample.encryptedLength) == true)) {
+                            sample.sampleInfo = &(sampleInfos[index]);
+                        }
+
+                        offset += BatchSubSampleCount(protectionMeta);
+                    }
+                }
+
+                result = opencdm_session_decrypt_batch(session, samples, count);
+
+                for (uint32_t index = 0; index < count; index++) {
+                    results[index] = (samples[index].sampleInfo == nullptr ? ERROR_INVALID_DECRYPT_BUFFER : samples[index].result);
 
-            //Get Stream Properties from GstCaps
-            MediaProperties *spPtr = nullptr;
-            MediaProperties streamProperties;
-            if(caps != nullptr){
-                gchar *capsStr = gst_caps_to_string (caps);
-                if (capsStr != nullptr) {
-                    Thunder::Plugin::CapsParser capsParser;
-                    capsParser.Parse(reinterpret_cast<const uint8_t*>(capsStr), strlen(capsStr));
-                    streamProperties.height = capsParser.GetHeight();
-                    streamProperties.width = capsParser.GetWidth();
-                    switch (capsParser.GetMediaType()) {
-                        case CDMi::MediaType::Video:
-                            streamProperties.media_type = MediaType_Video;
-                        break;
-
-                        case CDMi::MediaType::Audio:
-                            streamProperties.media_type = MediaType_Audio;
-                        break;
-
-                        case CDMi::MediaType::Data:
-                            streamProperties.media_type = MediaType_Data;
-                        break;
-
-                        default:
-                            streamProperties.media_type = MediaType_Unknown;
-                        break;
+                    if ((result == ERROR_NONE) && (results[index] != ERROR_NONE)) {
+                        result = results[index];
                     }
-                    spPtr = &streamProperties;
-                    g_free(capsStr);
-                } else {
-                    TRACE_L1("Could not convert caps to string");
                 }
             }
 
-            SampleInfo sampleInfo;
-            sampleInfo.subSample = subSampleInfoPtr;
-            sampleInfo.subSampleCount = subSampleCount;
-            sampleInfo.scheme = encScheme;
-            sampleInfo.pattern.clear_blocks = pattern.clear_blocks;
-            sampleInfo.pattern.encrypted_blocks = pattern.encrypted_blocks;
-            sampleInfo.iv = mappedIV;
-            sampleInfo.ivLength = mappedIVSize;
-            sampleInfo.keyId = mappedKeyID;
-            sampleInfo.keyIdLength = mappedKeyIDSize;
-
-            result = opencdm_session_decrypt_v2(session,
-                                                mappedData,
-                                                mappedDataSize,
-                                                &sampleInfo,
-                                                spPtr);
-
-            //Clean up
-            if(subSampleInfoPtr != nullptr) {
-               free(subSampleInfoPtr);
-           }
-        } else {
-            TRACE_L1("opencdm_gstreamer_session_decrypt_buffer: Missing Protection Metadata.");
-            result = ERROR_INVALID_DECRYPT_BUFFER;
+            scratch.Unlock();
         }
-
     }
 
-exit:
     return (result);
 }
-
@@ -70,8 +70,7 @@ EXTERNAL uint32_t opencdm_destruct_session_private(struct OpenCDMSession* sessio
  * \param IV Gstreamer buffer containing initial vector (IV) used during decryption.
  * \param keyID Gstreamer buffer containing keyID to use for decryption
  *
- * This method handles the Subsample mapping by consolidating all the encrypted data into one buffer before decrypting. This means the Subsample mappings are
- * not passed on to the DRM implementation side.
+ * This method passes the Subsample mapping (at most 255 entries) on to the DRM implementation side, which decrypts the sample in its original layout.
  *
  * For CBCS support, EncryptionScheme and EncryptionPattern information can be added as part of the ProtectionMeta in the given format below
  *      "cipher-mode"         G_TYPE_STRING   (One of the Four Character Code (FOURCC) Protection schemes as defined in https://www.iso.org/obp/ui/#iso:std:iso-iec:23001:-7:ed-3:v1:en)
@@ -105,6 +104,7 @@ EXTERNAL uint32_t opencdm_destruct_session_private(struct OpenCDMSession* sessio
  *      "skip_byte_block"     G_TYPE_UINT     (Present only cipher-mode is "cbcs")
  *
  * This method passes on the subsample mapping to the DRM implementation and assumes that the DRM implementaion will handle the decryption based on subsample mapping.
+ * The subsample mapping is kept in a per session table that is reused for every sample, so decrypting does not allocate once the largest mapping has been seen.
  *
  * \param session \ref OpenCDMSession instance.
  * \param buffer Gstreamer buffer containing encrypted data and related meta data. If applicable, decrypted data will be stored here after this call returns.
@@ -113,6 +113,34 @@ EXTERNAL uint32_t opencdm_destruct_session_private(struct OpenCDMSession* sessio
     
     EXTERNAL OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* session, GstBuffer* buffer, GstCaps* caps);
 
+/**
+ * \brief Performs decryption of a series of buffers of the same stream.
+ *
+ * Like \ref opencdm_gstreamer_session_decrypt_buffer, for every buffer in the
+ * array, but all buffers are handed to the DRM implementation in one go
+ * (see \ref opencdm_session_decrypt_batch). Meant for streams with many small
+ * samples, like audio.
+ *
+ * \param session \ref OpenCDMSession instance.
+ * \param buffers Gstreamer buffers containing encrypted data and related meta data.
+ * \param count Number of buffers.
+ * \param caps Caps of the stream the buffers belong to.
+ * \param results Array of count entries, receives the result of each buffer.
+ * \return Zero if all buffers were decrypted, otherwise the result of the first buffer that failed.
+ */
+    EXTERNAL OpenCDMError opencdm_gstreamer_session_decrypt_batch(struct OpenCDMSession* session, GstBuffer* buffers[], const uint32_t count, GstCaps* caps, OpenCDMError results[]);
+
+/**
+ * \brief Number of heap allocations the adapter did on behalf of the decrypts of a session.
+ *
+ * The sample metadata of a session grows to the largest sample seen and is reused from there on, so once
+ * decrypting reached a steady state this no longer changes. Only the gstreamer adapter implements this.
+ *
+ * \param session \ref OpenCDMSession instance.
+ * \return Number of allocations, zero if the adapter keeps no data for the session.
+ */
+    EXTERNAL uint64_t opencdm_gstreamer_session_allocations(struct OpenCDMSession* session);
+
 
 #ifdef __cplusplus
 }
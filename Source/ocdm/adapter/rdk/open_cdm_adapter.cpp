@@ -27,6 +27,251 @@
 #include <gst_svp_meta.h>
 #include "../CapsParser.h"
 
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+    // Fills the properties from the caps, false if the caps could not be read.
+    bool ParseCaps(GstCaps* caps, MediaProperties& properties)
+    {
+        bool result = false;
+        gchar *capsStr = gst_caps_to_string (caps);
+
+        if (capsStr != nullptr) {
+            WPEFramework::Plugin::CapsParser capsParser;
+            capsParser.Parse(reinterpret_cast<const uint8_t*>(capsStr), strlen(capsStr));
+            properties.height = capsParser.GetHeight();
+            properties.width = capsParser.GetWidth();
+            switch (capsParser.GetMediaType()) {
+                case CDMi::MediaType::Video:
+                    properties.media_type = MediaType_Video;
+                break;
+
+                case CDMi::MediaType::Audio:
+                    properties.media_type = MediaType_Audio;
+                break;
+
+                case CDMi::MediaType::Data:
+                    properties.media_type = MediaType_Data;
+                break;
+
+                default:
+                    properties.media_type = MediaType_Unknown;
+                break;
+            }
+            result = true;
+            g_free(capsStr);
+        } else {
+            TRACE_L1("Could not convert caps to string\n");
+        }
+
+        return (result);
+    }
+
+    // Per session secure video path state: the SVP context, a small pool of
+    // data blocks and the stream properties of the last caps seen.
+    // Allocating a data block per sample is expensive, so released blocks
+    // are kept and handed out again to any sample that fits. Blocks are
+    // allocated in power of two size classes, so a stream with slightly
+    // varying sample sizes settles on a few blocks.
+    class SecureContext {
+    public:
+        struct Block {
+            uint8_t* Data;
+            uint32_t Size;      // Allocated size, including the SVP header.
+            uint32_t Capacity;  // Payload bytes that fit after the header.
+        };
+
+    private:
+        static constexpr uint8_t MaxBlocks = 4;
+        static constexpr uint32_t MinimumCapacity = 4096;
+
+    public:
+        SecureContext(const SecureContext&) = delete;
+        SecureContext& operator=(const SecureContext&) = delete;
+
+        SecureContext(void* context)
+            : _lock()
+            , _context(context)
+            , _free()
+            , _hits(0)
+            , _misses(0)
+            , _caps(nullptr)
+            , _properties()
+            , _hasProperties(false)
+        {
+            _free.reserve(MaxBlocks);
+        }
+        ~SecureContext()
+        {
+            for (const Block& block : _free) {
+                gst_svp_free_data_block(_context, block.Data);
+            }
+            if (_caps != nullptr) {
+                gst_caps_unref(_caps);
+            }
+            TRACE_L1("SVP data block pool: %u hits, %u misses", _hits, _misses);
+        }
+
+    public:
+        void* Context() const
+        {
+            return (_context);
+        }
+        // Smallest pooled block that holds length bytes, or a new block of
+        // the size class of length.
+        Block Acquire(const uint32_t length)
+        {
+            Block result = { nullptr, 0, 0 };
+
+            _lock.Lock();
+
+            std::vector<Block>::iterator best(_free.end());
+
+            for (std::vector<Block>::iterator index(_free.begin()); index != _free.end(); index++) {
+                if ((index->Capacity >= length) && ((best == _free.end()) || (index->Capacity < best->Capacity))) {
+                    best = index;
+                }
+            }
+
+            if (best != _free.end()) {
+                result = *best;
+                _free.erase(best);
+                _hits++;
+            } else {
+                result.Capacity = SizeClass(length);
+                _misses++;
+            }
+
+            _lock.Unlock();
+
+            if (result.Data == nullptr) {
+                result.Size = gst_svp_allocate_data_block(_context, reinterpret_cast<void**>(&result.Data), result.Capacity, result.Capacity);
+            }
+
+            return (result);
+        }
+        void Release(const Block& block)
+        {
+            Block evicted(block);
+
+            _lock.Lock();
+
+            if (block.Data == nullptr) {
+                // Allocation failed, nothing to keep.
+            } else if (_free.size() < MaxBlocks) {
+                _free.push_back(block);
+                evicted.Data = nullptr;
+            } else {
+                // Keep the most recent sizes, make room by dropping the oldest block.
+                evicted = _free.front();
+                _free.erase(_free.begin());
+                _free.push_back(block);
+            }
+
+            _lock.Unlock();
+
+            if (evicted.Data != nullptr) {
+                gst_svp_free_data_block(_context, evicted.Data);
+            }
+        }
+        // Caps only change on a renegotiation, so they are parsed once. A
+        // reference is kept, so the caps can not be freed and another one
+        // show up at the same address.
+        bool Properties(GstCaps* caps, MediaProperties& properties)
+        {
+            _lock.Lock();
+
+            if (caps != _caps) {
+                if (_caps != nullptr) {
+                    gst_caps_unref(_caps);
+                }
+                _caps = gst_caps_ref(caps);
+                _properties = MediaProperties();
+                _hasProperties = ParseCaps(caps, _properties);
+            }
+
+            properties = _properties;
+            bool result = _hasProperties;
+
+            _lock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        static uint32_t SizeClass(const uint32_t length)
+        {
+            uint32_t result = MinimumCapacity;
+
+            while ((result < length) && (result <= (UINT32_MAX / 2))) {
+                result <<= 1;
+            }
+
+            return (std::max(result, length));
+        }
+
+    private:
+        Core::CriticalSection _lock;
+        void* _context;
+        std::vector<Block> _free;
+        uint32_t _hits;
+        uint32_t _misses;
+        GstCaps* _caps;
+        MediaProperties _properties;
+        bool _hasProperties;
+    };
+
+    inline void* SVPContext(struct OpenCDMSession* session)
+    {
+        SecureContext* secure = reinterpret_cast<SecureContext*>(session->SessionPrivateData());
+        return (secure != nullptr ? secure->Context() : nullptr);
+    }
+
+    // Without a session context there is no pool, blocks are allocated and
+    // freed per sample. A pooled block may be larger than the sample, use
+    // SampleSize() for the length of the data handed to the DRM.
+    SecureContext::Block AcquireBlock(struct OpenCDMSession* session, const uint32_t length)
+    {
+        SecureContext* secure = reinterpret_cast<SecureContext*>(session->SessionPrivateData());
+        SecureContext::Block result = { nullptr, 0, length };
+
+        if (secure != nullptr) {
+            result = secure->Acquire(length);
+        } else {
+            result.Size = gst_svp_allocate_data_block(nullptr, reinterpret_cast<void**>(&result.Data), length, length);
+        }
+
+        return (result);
+    }
+
+    // Size of the SVP header plus length bytes of payload in this block.
+    inline uint32_t SampleSize(const SecureContext::Block& block, const uint32_t length)
+    {
+        return (block.Size - block.Capacity + length);
+    }
+
+    void ReleaseBlock(struct OpenCDMSession* session, const SecureContext::Block& block)
+    {
+        SecureContext* secure = reinterpret_cast<SecureContext*>(session->SessionPrivateData());
+
+        if (secure != nullptr) {
+            secure->Release(block);
+        } else {
+            gst_svp_free_data_block(nullptr, block.Data);
+        }
+    }
+
+    bool StreamProperties(struct OpenCDMSession* session, GstCaps* caps, MediaProperties& properties)
+    {
+        SecureContext* secure = reinterpret_cast<SecureContext*>(session->SessionPrivateData());
+
+        return (secure != nullptr ? secure->Properties(caps, properties) : ParseCaps(caps, properties));
+    }
+
+}
+
 
 EXTERNAL OpenCDMError opencdm_gstreamer_transform_caps(GstCaps** caps)
 {
@@ -52,12 +297,14 @@ bool swapIVBytes(uint8_t *mappedIV,uint32_t mappedIVSize)
 
 uint32_t opencdm_construct_session_private(struct OpenCDMSession* session, void* &pvtData)
 {
-    bool success = gst_svp_ext_get_context(&pvtData, Server, (unsigned int)session);
+    void* context = nullptr;
+    bool success = gst_svp_ext_get_context(&context, Server, (unsigned int)session);
     if (success) {
       TRACE_L1("Initialized SVP context for server side ID = %X\n",(unsigned int)session);
       char buf[25] = { 0 };
       snprintf(buf, 25, "%X", (unsigned int)session);
       session->SetParameter("rpcId", buf);
+      pvtData = new SecureContext(context);
       return 0;
     }
     return 1;
@@ -65,7 +312,15 @@ uint32_t opencdm_construct_session_private(struct OpenCDMSession* session, void*
 
 uint32_t opencdm_destruct_session_private(struct OpenCDMSession* session, void* &pvtData)
 {
-    bool success = gst_svp_ext_free_context(pvtData);
+    bool success = true;
+    SecureContext* secure = reinterpret_cast<SecureContext*>(pvtData);
+    if (secure != nullptr) {
+        void* context = secure->Context();
+        // The pooled blocks belong to the context, free them first.
+        delete secure;
+        success = gst_svp_ext_free_context(context);
+        pvtData = nullptr;
+    }
     return (success ? 0 : 1);
 }
 
@@ -85,7 +340,7 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
         if(subSample == NULL && IV == NULL && keyID == NULL) {
             // no encrypted data, skip decryption...
             // But still need to transform buffer for SVP support
-            gst_buffer_svp_transform_from_cleardata(session->SessionPrivateData(), buffer, mediaType);
+            gst_buffer_svp_transform_from_cleardata(SVPContext(session), buffer, mediaType);
             gst_buffer_unmap(buffer, &dataMap);
             return(ERROR_NONE);
         }
@@ -156,10 +411,11 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
 
             if(totalEncrypted > 0)
             {
-                uint8_t* svpData;
-                gsize dataBlockSize = gst_svp_allocate_data_block(session->SessionPrivateData(), (void**) &svpData, totalEncrypted, totalEncrypted);
+                SecureContext::Block block = AcquireBlock(session, totalEncrypted);
+                uint8_t* svpData = block.Data;
+                gsize dataBlockSize = SampleSize(block, totalEncrypted);
 
-                uint8_t* encryptedDataIter = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(session->SessionPrivateData(), svpData));
+                uint8_t* encryptedDataIter = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(SVPContext(session), svpData));
 
                 uint32_t index = 0;
                 for (unsigned int position = 0; position < subSampleCount; position++) {
@@ -181,26 +437,27 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
 
                 if(result == ERROR_NONE) {
                     GstPerf* svpTransform_perf1 = new GstPerf("opencdm_svp_transform_subsample");
-                    gst_buffer_append_svp_transform(session->SessionPrivateData(), buffer, subSample, subSampleCount, svpData);
+                    gst_buffer_append_svp_transform(SVPContext(session), buffer, subSample, subSampleCount, svpData);
                     delete svpTransform_perf1;
                 }
-                gst_svp_free_data_block(session->SessionPrivateData(), svpData);
+                ReleaseBlock(session, block);
             } else {
                 // no encrypted data, skip decryption...
                 // But still need to transform buffer for SVP support
-                gst_buffer_svp_transform_from_cleardata(session->SessionPrivateData(), buffer, mediaType);
+                gst_buffer_svp_transform_from_cleardata(SVPContext(session), buffer, mediaType);
                 result = ERROR_NONE;
             }
             gst_byte_reader_free(reader);
             gst_buffer_unmap(subSample, &sampleMap);
         } else {
             uint8_t* encryptedData = NULL;
-            uint8_t* svpData = NULL;
+            SecureContext::Block block = AcquireBlock(session, mappedDataSize);
+            uint8_t* svpData = block.Data;
 
-            uint32_t dataBlockSize = gst_svp_allocate_data_block(session->SessionPrivateData(), (void**) &svpData, mappedDataSize, mappedDataSize);
+            uint32_t dataBlockSize = SampleSize(block, mappedDataSize);
 
             // Adjust data start after header
-            encryptedData = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(session->SessionPrivateData(), svpData));
+            encryptedData = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(SVPContext(session), svpData));
 
             memcpy(encryptedData, mappedData, mappedDataSize);
 
@@ -211,10 +468,10 @@ OpenCDMError opencdm_gstreamer_session_decrypt(struct OpenCDMSession* session, G
 
             if(result == ERROR_NONE){
                 GstPerf* svpTransform_perf2 = new GstPerf("opencdm_svp_transform_no_subsample");
-                gst_buffer_append_svp_transform(session->SessionPrivateData(), buffer, NULL, mappedDataSize, svpData);
+                gst_buffer_append_svp_transform(SVPContext(session), buffer, NULL, mappedDataSize, svpData);
                 delete svpTransform_perf2;
             }
-            gst_svp_free_data_block(session->SessionPrivateData(), svpData);
+            ReleaseBlock(session, block);
         }
 
         if (keyID != nullptr) {
@@ -339,33 +596,24 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
             //Get Stream Properties from GstCaps
             MediaProperties streamProperties = { 0 };
             if(caps != nullptr){
-                gchar *capsStr = gst_caps_to_string (caps);
-                if (capsStr != nullptr) {
-                    WPEFramework::Plugin::CapsParser capsParser;
-                    capsParser.Parse(reinterpret_cast<const uint8_t*>(capsStr), strlen(capsStr));
-                    streamProperties.height = capsParser.GetHeight();
-                    streamProperties.width = capsParser.GetWidth();
-                    switch (capsParser.GetMediaType()) {
-                        case CDMi::MediaType::Video:
-                            streamProperties.media_type = MediaType_Video;
+                if (StreamProperties(session, caps, streamProperties) == true) {
+                    switch (streamProperties.media_type) {
+                        case MediaType_Video:
                             mediaType = Video;
                             perfString += "_Video";
                         break;
 
-                        case CDMi::MediaType::Audio:
-                            streamProperties.media_type = MediaType_Audio;
+                        case MediaType_Audio:
                             mediaType = Audio;
                             perfString += "_Audio";
                         break;
 
-                        case CDMi::MediaType::Data:
-                            streamProperties.media_type = MediaType_Data;
+                        case MediaType_Data:
                             mediaType = Data;
                             perfString += "_Data";
                         break;
 
                         default:
-                            streamProperties.media_type = MediaType_Unknown;
                             perfString += "_Unknown";
                         break;
                     }
@@ -373,11 +621,8 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
                     if (subSample == nullptr && IV == nullptr && keyID == nullptr) {
                        perfString += "_clearData";
                     }
-
-                    g_free(capsStr);
                 } else {
                     perfString += "_NoGstCaps";
-                    TRACE_L1("Could not convert caps to string\n");
                 }
             }
             GstPerf perf(perfString.c_str());
@@ -385,7 +630,7 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
             if (subSample == nullptr && IV == nullptr && keyID == nullptr) {
             // no encrypted data, skip decryption...
             // But still need to transform buffer for SVP support
-                gst_buffer_svp_transform_from_cleardata(session->SessionPrivateData(), buffer, mediaType);
+                gst_buffer_svp_transform_from_cleardata(SVPContext(session), buffer, mediaType);
                 gst_buffer_unmap(buffer, &dataMap);
                 return(ERROR_NONE);
             }
@@ -430,10 +675,11 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
             sampleInfo.keyIdLength = mappedKeyIDSize;
 
             if(total_encrypted_bytes > 0) {
-               uint8_t* svpData;
-               uint32_t dataBlockSize = gst_svp_allocate_data_block(session->SessionPrivateData(), (void**) &svpData, mappedDataSize, mappedDataSize);
+               SecureContext::Block block = AcquireBlock(session, mappedDataSize);
+               uint8_t* svpData = block.Data;
+               uint32_t dataBlockSize = SampleSize(block, mappedDataSize);
 
-               void * encryptedData = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(session->SessionPrivateData(), svpData));
+               void * encryptedData = reinterpret_cast<uint8_t *>(gst_svp_header_get_start_of_data(SVPContext(session), svpData));
 
                 memcpy(encryptedData, mappedData, mappedDataSize);
 
@@ -447,14 +693,14 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
 
                if(result == ERROR_NONE) {
                   GstPerf* svpTransform_perf3 = new GstPerf("opencdm_svp_transform_subsample");
-                  gst_buffer_append_svp_transform(session->SessionPrivateData(), buffer, subSample, subSampleCount, svpData, mappedDataSize);
+                  gst_buffer_append_svp_transform(SVPContext(session), buffer, subSample, subSampleCount, svpData, mappedDataSize);
                   delete svpTransform_perf3;
                }
-               gst_svp_free_data_block(session->SessionPrivateData(), svpData);
+               ReleaseBlock(session, block);
            } else {
                // no encrypted data, skip decryption...
                // But still need to transform buffer for SVP support
-               gst_buffer_svp_transform_from_cleardata(session->SessionPrivateData(), buffer, mediaType);
+               gst_buffer_svp_transform_from_cleardata(SVPContext(session), buffer, mediaType);
                result = ERROR_NONE;
            }
 
@@ -486,3 +732,29 @@ OpenCDMError opencdm_gstreamer_session_decrypt_buffer(struct OpenCDMSession* ses
 exit:
     return (result);
 }
+
+OpenCDMError opencdm_gstreamer_session_decrypt_batch(struct OpenCDMSession* session, GstBuffer* buffers[], const uint32_t count, GstCaps* caps, OpenCDMError results[]) {
+
+    OpenCDMError result (ERROR_INVALID_SESSION);
+
+    if (session != nullptr) {
+
+        if ((count > 0) && ((buffers == nullptr) || (results == nullptr))) {
+            result = ERROR_INVALID_ARG;
+        } else {
+            result = ERROR_NONE;
+
+            // Every buffer needs its own secure video path handling, so they
+            // can not be handed over as one batch.
+            for (uint32_t index = 0; index < count; index++) {
+                results[index] = opencdm_gstreamer_session_decrypt_buffer(session, buffers[index], caps);
+
+                if ((result == ERROR_NONE) && (results[index] != ERROR_NONE)) {
+                    result = results[index];
+                }
+            }
+        }
+    }
+
+    return (result);
+}
@@ -456,6 +456,24 @@ const char* opencdm_session_buffer_id(const struct OpenCDMSession* session)
     return (result);
 }
 
+/**
+ * Gets the adapter private data of a session.
+ * \param session \ref OpenCDMSession instance.
+ * \return Private data of the adapter, NULL if it has none.
+ */
+void* opencdm_session_private_data(const struct OpenCDMSession* session)
+{
+    void* result = nullptr;
+
+    ASSERT(session != nullptr);
+
+    if (session != nullptr) {
+        result = session->SessionPrivateData();
+    }
+
+    return (result);
+}
+
 /**
  * Checks if a session has a specific keyid. Will check both BE/LE
  * \param session \ref OpenCDMSession instance.
@@ -706,6 +724,157 @@ OpenCDMError opencdm_session_decrypt_v2(struct OpenCDMSession* session,
     return (result);
 }
 
+OpenCDMError opencdm_session_decrypt_subsamples(struct OpenCDMSession* session,
+    uint8_t encrypted[],
+    const uint32_t encryptedLength,
+    const SampleInfo* sampleInfo,
+    const uint32_t initWithLast15,
+    const MediaProperties* properties)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+
+    if (session != nullptr) {
+        result = encryptedLength > 0 ? static_cast<OpenCDMError>(session->Decrypt(
+            encrypted, encryptedLength, sampleInfo, initWithLast15, properties)) : OpenCDMError::ERROR_NONE;
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_get_decrypt_stats(struct OpenCDMSession* session,
+    DecryptStats* stats)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+    ASSERT(stats != nullptr);
+
+    if (session != nullptr) {
+        if (stats == nullptr) {
+            result = OpenCDMError::ERROR_INVALID_ARG;
+        } else {
+            session->DecryptStatistics(*stats);
+            result = OpenCDMError::ERROR_NONE;
+        }
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_batch(struct OpenCDMSession* session,
+    DecryptSample samples[],
+    const uint32_t count)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+    ASSERT((samples != nullptr) || (count == 0));
+
+    if (session != nullptr) {
+        if ((samples == nullptr) && (count != 0)) {
+            result = OpenCDMError::ERROR_INVALID_ARG;
+        } else if (count == 0) {
+            result = OpenCDMError::ERROR_NONE;
+        } else {
+            result = static_cast<OpenCDMError>(session->DecryptBatch(samples, count));
+        }
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_acquire(struct OpenCDMSession* session,
+    const uint32_t length,
+    uint8_t** buffer)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+    ASSERT(buffer != nullptr);
+
+    if (session != nullptr) {
+        if (buffer == nullptr) {
+            result = OpenCDMError::ERROR_INVALID_ARG;
+        } else {
+            result = static_cast<OpenCDMError>(session->DecryptAcquire(length, *buffer));
+        }
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_in_place(struct OpenCDMSession* session,
+    const uint32_t length,
+    const SampleInfo* sampleInfo,
+    const MediaProperties* properties)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+
+    if (session != nullptr) {
+        result = length > 0 ? static_cast<OpenCDMError>(session->DecryptInPlace(
+            length, sampleInfo, properties)) : OpenCDMError::ERROR_NONE;
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_release(struct OpenCDMSession* session)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+
+    if (session != nullptr) {
+        session->DecryptRelease();
+        result = OpenCDMError::ERROR_NONE;
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_submit(struct OpenCDMSession* session,
+    uint8_t encrypted[],
+    const uint32_t encryptedLength,
+    const SampleInfo* sampleInfo,
+    const MediaProperties* properties,
+    uint32_t* ticket)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+    ASSERT(ticket != nullptr);
+
+    if (session != nullptr) {
+        if (ticket == nullptr) {
+            result = OpenCDMError::ERROR_INVALID_ARG;
+        } else {
+            result = static_cast<OpenCDMError>(session->DecryptSubmit(
+                encrypted, encryptedLength, sampleInfo, properties, *ticket));
+        }
+    }
+
+    return (result);
+}
+
+OpenCDMError opencdm_session_decrypt_wait(struct OpenCDMSession* session,
+    const uint32_t ticket,
+    const uint32_t waitTime)
+{
+    OpenCDMError result(OpenCDMError::ERROR_INVALID_SESSION);
+
+    ASSERT(session != nullptr);
+
+    if (session != nullptr) {
+        result = static_cast<OpenCDMError>(session->DecryptWait(ticket, waitTime));
+    }
+
+    return (result);
+}
+
 /**
  * \brief Get metrics associated with a DRM session.
  *
@@ -746,15 +915,19 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
     {
         bool result = false;
         uint64_t timeOut(Core::Time::Now().Add(waitTime).Ticks());
+        uint8_t buffer[16];
+        const string key(reinterpret_cast<const char*>(NormaliseKeyId(keyLength, keyId, buffer)), keyLength);
+        Core::Event signal(false, true);
 
-        do {
-            _adminLock.Lock();
+        _keyLock.Lock();
 
-            KeyMap::const_iterator session(_sessionKeys.begin());
+        do {
+            KeyIndex::const_iterator index(_keyIndex.find(key));
 
-            for  (; session != _sessionKeys.end(); ++session) {
-                if (!system || session->second->BelongsTo(system) == true) {
-                    if(session->second->Status(keyLength, keyId) == status) {
+            if (index != _keyIndex.end()) {
+                for (const KeyEntry& entry : index->second) {
+                    if ((entry.Status == status) && ((system == nullptr) || (entry.Session->BelongsTo(system) == true))) {
+                        sessionId = entry.Session->SessionId();
                         result = true;
                         break;
                     }
@@ -762,26 +935,36 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
             }
 
             if (result == false) {
-                Exchange::KeyId paramKey(keyId, keyLength);
-                _interested++;
+                uint64_t now(Core::Time::Now().Ticks());
 
-                _adminLock.Unlock();
+                if (now < timeOut) {
+                    // Only updates on this key id will wake us up.
+                    _waiters[key].push_back(&signal);
+                    signal.ResetEvent();
 
-                TRACE_L1("Waiting for KeyId: %s", paramKey.ToString().c_str());
+                    _keyLock.Unlock();
 
-                uint64_t now(Core::Time::Now().Ticks());
+                    TRACE_L1("Waiting for KeyId: %s", Exchange::KeyId(keyId, keyLength).ToString().c_str());
 
-                if (now < timeOut) {
-                    _signal.Lock(static_cast<uint32_t>((timeOut - now) / Core::Time::TicksPerMillisecond));
-                }
+                    signal.Lock(static_cast<uint32_t>((timeOut - now) / Core::Time::TicksPerMillisecond));
 
-                Core::InterlockedDecrement(_interested);
-            } else {
-                sessionId = session->first;
-                _adminLock.Unlock();
+                    _keyLock.Lock();
+
+                    WaitList::iterator waiters(_waiters.find(key));
+
+                    ASSERT(waiters != _waiters.end());
+
+                    waiters->second.remove(&signal);
+
+                    if (waiters->second.empty() == true) {
+                        _waiters.erase(waiters);
+                    }
+                }
             }
         } while ((result == false) && (timeOut > Core::Time::Now().Ticks()));
 
+        _keyLock.Unlock();
+
         return (result);
     }
     OpenCDMSession* OpenCDMAccessor::Session(const std::string& sessionId)
@@ -810,7 +993,17 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
         KeyMap::iterator index(_sessionKeys.find(sessionId));
 
         if (index == _sessionKeys.end()) {
+            _keyLock.Lock();
+
             _sessionKeys.insert(std::pair<string, OpenCDMSession*>(sessionId, session));
+
+            // Keys may have been reported while the session was being created.
+            session->KeyStatuses([this, session](const uint8_t length, const uint8_t id[], const Exchange::ISession::KeyStatus status) {
+                uint8_t buffer[16];
+                _keyIndex[string(reinterpret_cast<const char*>(NormaliseKeyId(length, id, buffer)), length)].push_back({ session, status });
+            });
+
+            _keyLock.Unlock();
         } else {
             TRACE_L1("Same session created, again ???? Keep the old one than. [%s]",
                 sessionId.c_str());
@@ -825,7 +1018,25 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
         KeyMap::iterator index(_sessionKeys.find(sessionId));
 
         if (index != _sessionKeys.end()) {
+            OpenCDMSession* session = index->second;
+
+            _keyLock.Lock();
+
             _sessionKeys.erase(index);
+
+            KeyIndex::iterator entries(_keyIndex.begin());
+
+            while (entries != _keyIndex.end()) {
+                entries->second.remove_if([session](const KeyEntry& entry) { return (entry.Session == session); });
+
+                if (entries->second.empty() == true) {
+                    entries = _keyIndex.erase(entries);
+                } else {
+                    ++entries;
+                }
+            }
+
+            _keyLock.Unlock();
         } else {
             TRACE_L1("A session is destroyed of which we were not aware [%s]",
                 sessionId.c_str());
@@ -834,6 +1045,42 @@ bool OpenCDMAccessor::WaitForKey(const uint8_t keyLength, const uint8_t keyId[],
         _adminLock.Unlock();
     }
 
+    void OpenCDMAccessor::KeyUpdate(OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[], const Exchange::ISession::KeyStatus status)
+    {
+        uint8_t buffer[16];
+        const string key(reinterpret_cast<const char*>(NormaliseKeyId(keyLength, keyId, buffer)), keyLength);
+
+        _keyLock.Lock();
+
+        KeyMap::const_iterator known(_sessionKeys.find(session->SessionId()));
+
+        // Sessions not (or no longer) registered are picked up by AddSession.
+        if ((known != _sessionKeys.end()) && (known->second == session)) {
+            std::list<KeyEntry>& entries(_keyIndex[key]);
+            std::list<KeyEntry>::iterator entry(entries.begin());
+
+            while ((entry != entries.end()) && (entry->Session != session)) {
+                ++entry;
+            }
+
+            if (entry == entries.end()) {
+                entries.push_back({ session, status });
+            } else {
+                entry->Status = status;
+            }
+
+            WaitList::iterator waiters(_waiters.find(key));
+
+            if (waiters != _waiters.end()) {
+                for (Core::Event* waiter : waiters->second) {
+                    waiter->SetEvent();
+                }
+            }
+        }
+
+        _keyLock.Unlock();
+    }
+
     void OpenCDMAccessor::SystemBeingDestructed(OpenCDMSystem* system)
     {
         _adminLock.Lock();
@@ -157,6 +157,33 @@ typedef struct {
     MediaType media_type;
 } MediaProperties;
 
+// Fixed size latency histogram, in microseconds. Bucket 0 counts the zero
+// durations, bucket n the durations in [2^(n-1), 2^n), the last bucket also
+// holds everything beyond.
+#define OPENCDM_DECRYPT_HISTOGRAM_BUCKETS 32
+
+typedef struct {
+    uint64_t count;                                      // Number of recorded durations.
+    uint64_t total;                                      // Sum of all recorded durations.
+    uint32_t maximum;                                    // Longest recorded duration.
+    uint32_t buckets[OPENCDM_DECRYPT_HISTOGRAM_BUCKETS];
+} DecryptHistogram;
+
+typedef struct {
+    uint64_t bytes;    // Number of bytes decrypted.
+    uint64_t duration; // Time spent on decrypting them, in microseconds, so bytes/s is (bytes * 1000000) / duration.
+} DecryptThroughput;
+
+// Decrypt statistics of a session, see opencdm_session_get_decrypt_stats
+typedef struct {
+    DecryptHistogram lockWait;       // Waiting for the decrypt lock.
+    DecryptHistogram bufferWait;     // Waiting in RequestProduce for the buffer, before the sample can be handed over.
+    DecryptHistogram serverDecrypt;  // From handing over the sample until the server handed it back decrypted.
+    DecryptHistogram copyBack;       // Copying the decrypted sample back to the caller.
+    DecryptThroughput audio;
+    DecryptThroughput video;
+} DecryptStats;
+
 
 /**
  * Key status.
@@ -188,6 +215,8 @@ typedef enum {
     ERROR_INVALID_DECRYPT_BUFFER = 0x80000004,
     ERROR_OUT_OF_MEMORY = 0x80000005,
     ERROR_METHOD_NOT_IMPLEMENTED = 0x80000006,
+    ERROR_TIMED_OUT = 0x80000007,
+    ERROR_INPROGRESS = 0x80000008,
     ERROR_FAIL = 0x80004005,
     ERROR_INVALID_ARG = 0x80070057,
     ERROR_SERVER_INTERNAL_ERROR = 0x8004C600,
@@ -197,6 +226,15 @@ typedef enum {
 
 } OpenCDMError;
 
+// One sample of a batch, see opencdm_session_decrypt_batch
+typedef struct {
+    uint8_t*               encrypted;        // Buffer containing encrypted data, decrypted data is stored here.
+    uint32_t               encryptedLength;  // Length of the encrypted data buffer (in bytes).
+    const SampleInfo*      sampleInfo;       // Per Sample information needed to decrypt this sample.
+    const MediaProperties* streamProperties; // Info about current stream, can be NULL.
+    OpenCDMError           result;           // Result of the decryption of this sample.
+} DecryptSample;
+
 /**
  * OpenCDM bool type. 0 is false, 1 is true.
  */
@@ -547,6 +585,14 @@ EXTERNAL OpenCDMError opencdm_session_system_error(const struct OpenCDMSession*
  */
 EXTERNAL const char* opencdm_session_buffer_id(const struct OpenCDMSession* session);
 
+/**
+ * Gets the adapter private data of a session.
+ * \param session \ref OpenCDMSession instance.
+ * \return The data created by opencdm_construct_session_private of the
+ * adapter, NULL if the adapter has none. Valid as long as \ref session is valid.
+ */
+EXTERNAL void* opencdm_session_private_data(const struct OpenCDMSession* session);
+
 /**
  * Closes a session.
  * \param session \ref OpenCDMSession instance.
@@ -598,6 +644,19 @@ EXTERNAL OpenCDMError opencdm_session_decrypt(struct OpenCDMSession* session,
     uint32_t initWithLast15);
 #endif // __cplusplus
 
+/**
+ * \brief Get the decrypt statistics of a session.
+ *
+ * Every decrypt of the session records where its time went, this returns what
+ * has been recorded since the session did its first decrypt. The throughput
+ * is only recorded for samples that come with MediaProperties.
+ * \param session Instance of \ref OpenCDMSession.
+ * \param stats Receives the statistics.
+ * \return Zero on success, non-zero on error.
+ */
+EXTERNAL OpenCDMError opencdm_session_get_decrypt_stats(struct OpenCDMSession* session,
+    DecryptStats* stats);
+
 /**
  * \brief Get metrics associated with a DRM session.
  *
@@ -638,6 +697,137 @@ EXTERNAL OpenCDMError opencdm_session_decrypt_v2(struct OpenCDMSession* session,
     const SampleInfo* sampleInfo,
     const MediaProperties* streamProperties);
 
+/**
+ * \brief Performs decryption of a sample in its original layout.
+ *
+ * Like \ref opencdm_session_decrypt_v2, the subsample map in sampleInfo is
+ * handed to the DRM implementation, which decrypts the encrypted ranges in
+ * place, so the caller does not gather and scatter them.
+ * \param session \ref OpenCDMSession instance.
+ * \param encrypted Buffer containing the sample, decrypted in place.
+ * \param encryptedLength Length of the sample (in bytes), the subsample map
+ * must not describe more than this.
+ * \param sampleInfo Per Sample information, including the subsample map.
+ * \param initWithLast15 Whether decryption context needs to be initialized with
+ * last 15 bytes. Currently this only applies to PlayReady DRM.
+ * \param streamProperties Provides info about current stream, can be NULL.
+ * \return Zero on success, non-zero on error.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_subsamples(struct OpenCDMSession* session,
+    uint8_t encrypted[],
+    const uint32_t encryptedLength,
+    const SampleInfo* sampleInfo,
+    const uint32_t initWithLast15,
+    const MediaProperties* streamProperties);
+
+/**
+ * \brief Hands out the sample area of the shared buffer of the session.
+ *
+ * Zero copy alternative to \ref opencdm_session_decrypt_v2. The caller writes
+ * (e.g. demuxes) the encrypted sample straight into the returned buffer, has
+ * it decrypted in place with \ref opencdm_session_decrypt_in_place and reads
+ * the result from the same buffer. No copy into, or out of, the shared buffer
+ * is made. The buffer is owned by the caller until
+ * \ref opencdm_session_decrypt_release is called, all three calls must be
+ * made from the same thread. Until then other decrypts on this session wait,
+ * decrypts on other sessions are not held up.
+ * \param session \ref OpenCDMSession instance.
+ * \param length Length of the sample that will be written (in bytes).
+ * \param buffer Output parameter that will point to the sample area.
+ * \return Zero on success, ERROR_BUFFER_TOO_SMALL if the sample does not fit
+ * the shared buffer, non-zero on other errors.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_acquire(struct OpenCDMSession* session,
+    const uint32_t length,
+    uint8_t** buffer);
+
+/**
+ * \brief Decrypts the sample written in the buffer obtained with
+ * \ref opencdm_session_decrypt_acquire, in place.
+ *
+ * \param session \ref OpenCDMSession instance.
+ * \param length Length of the sample in the buffer (in bytes).
+ * \param sampleInfo Per Sample information needed to decrypt this sample
+ * \param streamProperties Provides info about current stream
+ * \return Zero on success, non-zero on error.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_in_place(struct OpenCDMSession* session,
+    const uint32_t length,
+    const SampleInfo* sampleInfo,
+    const MediaProperties* streamProperties);
+
+/**
+ * \brief Hands the buffer obtained with \ref opencdm_session_decrypt_acquire
+ * back to the session. The buffer may no longer be accessed after this call.
+ *
+ * \param session \ref OpenCDMSession instance.
+ * \return Zero on success, non-zero on error.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_release(struct OpenCDMSession* session);
+
+/**
+ * \brief Queues a sample for decryption without waiting for the result.
+ *
+ * The sample is placed in one of the slots of the decrypt ring of the session
+ * and handed to the DRM implementation in submission order. This allows the
+ * caller to prepare (and queue) the next sample while the previous one is
+ * still being decrypted. The result is collected with
+ * \ref opencdm_session_decrypt_wait.
+ * The encrypted buffer, sampleInfo and streamProperties must stay valid until
+ * the result of the submitted sample has been collected. When the session is
+ * destructed, the sample being decrypted is finished first; samples that are
+ * still queued complete with ERROR_INVALID_SESSION.
+ * \param session \ref OpenCDMSession instance.
+ * \param encrypted Buffer containing encrypted data. If applicable, decrypted
+ * data will be stored here once the sample is completed.
+ * \param encryptedLength Length of encrypted data buffer (in bytes).
+ * \param sampleInfo Per Sample information needed to decrypt this sample
+ * \param streamProperties Provides info about current stream
+ * \param ticket Output parameter identifying the submitted sample.
+ * \return Zero on success, ERROR_INPROGRESS if all slots are still awaiting
+ * collection (nothing is queued, collect a result and submit again),
+ * non-zero on other errors.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_submit(struct OpenCDMSession* session,
+    uint8_t encrypted[],
+    const uint32_t encryptedLength,
+    const SampleInfo* sampleInfo,
+    const MediaProperties* streamProperties,
+    uint32_t* ticket);
+
+/**
+ * \brief Waits for, and collects the result of, a submitted sample.
+ *
+ * \param session \ref OpenCDMSession instance.
+ * \param ticket Ticket as returned by \ref opencdm_session_decrypt_submit.
+ * \param waitTime Maximum allowed time to block (in miliseconds).
+ * \return Result of the decryption, ERROR_TIMED_OUT if the sample did not
+ * complete in time (it can be waited for again), ERROR_INVALID_ARG for an
+ * unknown ticket.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_wait(struct OpenCDMSession* session,
+    const uint32_t ticket,
+    const uint32_t waitTime);
+
+/**
+ * \brief Performs decryption of a series of samples in one go.
+ *
+ * The samples are handed to the DRM implementation one after the other
+ * through the session buffer, without releasing it in between, so no other
+ * decrypt request can get in between. The decrypt lock and the buffer are
+ * acquired once for the whole batch; each sample still takes one round trip
+ * to the DRM implementation. Meant for streams with many small samples, like
+ * audio.
+ * \param session \ref OpenCDMSession instance.
+ * \param samples Array of samples, the result of each sample is stored in it.
+ * \param count Number of samples in the array.
+ * \return Zero if all samples were decrypted, otherwise the result of the
+ * first sample that failed.
+ */
+EXTERNAL OpenCDMError opencdm_session_decrypt_batch(struct OpenCDMSession* session,
+    DecryptSample samples[],
+    const uint32_t count);
+
 /**
  * @brief Close the cached open connection if it exists.
  *
@@ -74,6 +74,83 @@ class SessionPrivate {
 
 static SessionPrivate SessionPvt;
 
+#ifdef OCDM_SESSION_BUFFER_PREWARM
+// Attaches the session buffers of new sessions in the background, so the
+// first decrypt of a session finds its buffer already mapped.
+class BufferPrewarm : public Core::Thread {
+public:
+    BufferPrewarm(const BufferPrewarm&) = delete;
+    BufferPrewarm& operator=(const BufferPrewarm&) = delete;
+
+    BufferPrewarm()
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("OCDMBufferPrewarm"))
+        , _lock()
+        , _queued(false, true)
+        , _sessions()
+    {
+    }
+    ~BufferPrewarm() override
+    {
+        Block();
+        _queued.SetEvent();
+        Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        for (OpenCDMSession* session : _sessions) {
+            session->Release();
+        }
+    }
+
+public:
+    void Add(OpenCDMSession* session)
+    {
+        session->AddRef();
+
+        _lock.Lock();
+        _sessions.push_back(session);
+        _queued.SetEvent();
+        _lock.Unlock();
+
+        Run();
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        OpenCDMSession* session = nullptr;
+
+        _lock.Lock();
+        if (_sessions.empty() == false) {
+            session = _sessions.front();
+            _sessions.pop_front();
+        } else {
+            _queued.ResetEvent();
+        }
+        _lock.Unlock();
+
+        if (session != nullptr) {
+            session->AttachBuffer();
+            session->Release();
+        } else {
+            _queued.Lock(Core::infinite);
+        }
+
+        return (0);
+    }
+
+private:
+    Core::CriticalSection _lock;
+    Core::Event _queued;
+    std::list<OpenCDMSession*> _sessions;
+};
+
+/* static */ void OpenCDMSession::Prewarm(OpenCDMSession* session)
+{
+    static BufferPrewarm prewarm;
+
+    prewarm.Add(session);
+}
+#endif
+
 /* static */ OpenCDMError OpenCDMSession::CreateSession(struct OpenCDMSystem* system,
                             const LicenseType licenseType, const char initDataType[],
                             const uint8_t initData[], const uint16_t initDataLength,
@@ -111,6 +188,13 @@ static SessionPrivate SessionPvt;
 
 OpenCDMSession::~OpenCDMSession()
 {
+    // The ring worker decrypts through the session, stop it before any of
+    // that is torn down.
+    if (_decryptRing != nullptr) {
+        delete _decryptRing.load();
+        _decryptRing = nullptr;
+    }
+
     SessionPvt.Destruct(this, _pvtData);
 
     OpenCDMAccessor::Instance()->RemoveSession(_sessionId);
@@ -124,5 +208,10 @@ OpenCDMSession::~OpenCDMSession()
         DecryptSession(nullptr);
     }
 
+    for (const KeySnapshot* retired : _retiredKeys) {
+        delete retired;
+    }
+    delete _keys.load();
+
     TRACE_L1("Destructed the Session Client side: %p", this);
 }
@@ -26,11 +26,40 @@
 #include "open_cdm.h"
 
 #include <atomic>
+#include <memory>
+#include <unordered_map>
 
 using namespace Thunder;
 
 extern Core::CriticalSection _systemLock;
 
+// Exchange::KeyId considers a 16 byte key id equal to its GUID byte swapped
+// form, as PlayReady reports key ids little endian where the other systems
+// do not. Both forms normalise to the smaller of the two (written to buffer
+// if that is the swapped one), so they can be hashed and sorted as bytes.
+inline const uint8_t* NormaliseKeyId(const uint8_t length, const uint8_t id[], uint8_t buffer[16])
+{
+    const uint8_t* result = id;
+
+    if (length == 16) {
+        buffer[0] = id[3];
+        buffer[1] = id[2];
+        buffer[2] = id[1];
+        buffer[3] = id[0];
+        buffer[4] = id[5];
+        buffer[5] = id[4];
+        buffer[6] = id[7];
+        buffer[7] = id[6];
+        ::memcpy(&buffer[8], &id[8], 8);
+
+        if (::memcmp(buffer, id, 16) < 0) {
+            result = buffer;
+        }
+    }
+
+    return (result);
+}
+
 struct OpenCDMSystem {
     OpenCDMSystem(const char system[], const std::string& metadata) : _keySystem(system), _metadata(metadata) {}
     ~OpenCDMSystem() = default;
@@ -50,6 +79,24 @@ struct OpenCDMAccessor : public Exchange::IAccessorOCDM {
 private:
     typedef std::map<string, OpenCDMSession*> KeyMap;
 
+    struct KeyEntry {
+        OpenCDMSession* Session;
+        Exchange::ISession::KeyStatus Status;
+    };
+
+    // Normalised key id to all sessions that reported a status for that key,
+    // and to the WaitForKey callers that are waiting for it. Both are guarded
+    // by _keyLock, not by _adminLock, as key updates come in on the RPC
+    // threads while _adminLock can be held for the duration of a remote call.
+    // _sessionKeys is only changed holding both locks.
+    typedef std::unordered_map<string, std::list<KeyEntry>> KeyIndex;
+    typedef std::unordered_map<string, std::list<Core::Event*>> WaitList;
+
+    // Answers of the server on capability queries, they only change if the
+    // server does, so they are dropped whenever the channel is (re)opened.
+    typedef std::map<std::pair<string, string>, bool> SupportMap;
+    typedef std::map<string, string> MetadataMap;
+
 protected:
     OpenCDMAccessor(const TCHAR domainName[])
         : _refCount(1)
@@ -58,9 +105,12 @@ protected:
         , _client()
         , _remote(nullptr)
         , _adminLock()
-        , _signal(false, true)
-        , _interested(0)
+        , _keyLock()
         , _sessionKeys()
+        , _keyIndex()
+        , _waiters()
+        , _supported()
+        , _metadata()
     {
         ASSERT(domainName != nullptr);
         _domain = domainName;
@@ -86,6 +136,9 @@ protected:
 
             _remote = _client->Open<Exchange::IAccessorOCDM>(_T("OpenCDMImplementation"));
 
+            _supported.clear();
+            _metadata.clear();
+
             if (_remote == nullptr) {
                 TRACE_L1("Failed to open a channel to OCDM implementation");
 
@@ -99,7 +152,7 @@ protected:
     }
 
 public:
-    OpenCDMAccessor() : _signal(false, true) { ASSERT(false); }
+    OpenCDMAccessor() { ASSERT(false); }
     OpenCDMAccessor(const OpenCDMAccessor&) = delete;
     OpenCDMAccessor& operator=(const OpenCDMAccessor&) = delete;
 
@@ -165,8 +218,14 @@ public:
 
         _adminLock.Lock();
 
-        if (_remote != nullptr) {
+        const std::pair<string, string> query(keySystem, mimeType);
+        SupportMap::const_iterator index(_supported.find(query));
+
+        if (index != _supported.end()) {
+            result = index->second;
+        } else if (_remote != nullptr) {
             result = _remote->IsTypeSupported(keySystem, mimeType);
+            _supported.emplace(query, result);
         }
 
         _adminLock.Unlock();
@@ -180,8 +239,17 @@ public:
 
         _adminLock.Lock();
 
-        if (_remote != nullptr) {
+        MetadataMap::const_iterator index(_metadata.find(keySystem));
+
+        if (index != _metadata.end()) {
+            metadata = index->second;
+            result = Exchange::OCDM_SUCCESS;
+        } else if (_remote != nullptr) {
             result = _remote->Metadata(keySystem, metadata);
+
+            if (result == Exchange::OCDM_SUCCESS) {
+                _metadata.emplace(keySystem, metadata);
+            }
         }
 
         _adminLock.Unlock();
@@ -249,22 +317,7 @@ public:
 
     void AddSession(OpenCDMSession* sessionId);
     void RemoveSession(const string& sessionId);
-    void KeyUpdate()
-    {
-        _adminLock.Lock();
-
-        if (_interested != 0) {
-            // We need to notify the "other side", they are expecting an update
-            _signal.SetEvent();
-
-            while (_interested != 0) {
-                ::SleepMs(0);
-            }
-
-            _signal.ResetEvent();
-        }
-        _adminLock.Unlock();
-    }
+    void KeyUpdate(OpenCDMSession* session, const uint8_t keyLength, const uint8_t keyId[], const Exchange::ISession::KeyStatus status);
 
     uint64_t GetDrmSystemTime(const std::string& keySystem) const override
     {
@@ -485,14 +538,93 @@ private:
     mutable Core::ProxyType<RPC::CommunicatorClient> _client;
     mutable Exchange::IAccessorOCDM* _remote;
     mutable Core::CriticalSection _adminLock;
-    mutable Core::Event _signal;
-    mutable volatile uint32_t _interested;
+    mutable Core::CriticalSection _keyLock;
     KeyMap _sessionKeys;
+    KeyIndex _keyIndex;
+    mutable WaitList _waiters;
+    mutable SupportMap _supported;
+    mutable MetadataMap _metadata;
 };
 
 struct OpenCDMSession {
 private:
-    using KeyStatusesMap = std::list<Exchange::KeyId>;
+    // Immutable set of key statuses, sorted on the normalised key id. Every
+    // status update publishes a new snapshot, so readers can do a binary
+    // search on the one they picked up without taking a lock.
+    class KeySnapshot {
+    public:
+        struct Entry {
+            string Key;
+            string Id;
+            Exchange::ISession::KeyStatus Status;
+        };
+
+    public:
+        KeySnapshot& operator=(const KeySnapshot&) = delete;
+
+        KeySnapshot()
+            : _entries()
+        {
+        }
+        KeySnapshot(const KeySnapshot& copy, const uint8_t keyIDLength, const uint8_t keyID[], const Exchange::ISession::KeyStatus status)
+            : _entries(copy._entries)
+        {
+            uint8_t buffer[16];
+            const uint8_t* key = NormaliseKeyId(keyIDLength, keyID, buffer);
+            const uint32_t index = LowerBound(keyIDLength, key);
+
+            if ((index < _entries.size()) && (Compare(_entries[index], keyIDLength, key) == 0)) {
+                _entries[index].Status = status;
+            } else {
+                _entries.insert(_entries.begin() + index, Entry({ string(reinterpret_cast<const char*>(key), keyIDLength), string(reinterpret_cast<const char*>(keyID), keyIDLength), status }));
+            }
+        }
+        ~KeySnapshot() = default;
+
+    public:
+        const Entry* Find(const uint8_t keyIDLength, const uint8_t keyID[]) const
+        {
+            uint8_t buffer[16];
+            const uint8_t* key = NormaliseKeyId(keyIDLength, keyID, buffer);
+            const uint32_t index = LowerBound(keyIDLength, key);
+
+            return (((index < _entries.size()) && (Compare(_entries[index], keyIDLength, key) == 0)) ? &(_entries[index]) : nullptr);
+        }
+        template <typename ACTION>
+        void Visit(ACTION&& action) const
+        {
+            // Report the ids as the DRM did, not in their normalised form.
+            for (const Entry& entry : _entries) {
+                action(static_cast<uint8_t>(entry.Id.length()), reinterpret_cast<const uint8_t*>(entry.Id.data()), entry.Status);
+            }
+        }
+
+    private:
+        static int Compare(const Entry& entry, const uint8_t keyLength, const uint8_t key[])
+        {
+            return (entry.Key.compare(0, string::npos, reinterpret_cast<const char*>(key), keyLength));
+        }
+        uint32_t LowerBound(const uint8_t keyLength, const uint8_t key[]) const
+        {
+            uint32_t low = 0;
+            uint32_t high = static_cast<uint32_t>(_entries.size());
+
+            while (low < high) {
+                const uint32_t middle = low + ((high - low) / 2);
+
+                if (Compare(_entries[middle], keyLength, key) < 0) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+
+            return (low);
+        }
+
+    private:
+        std::vector<Entry> _entries;
+    };
 
     class Sink : public Exchange::ISession::ICallback {
     //private:
@@ -551,7 +683,14 @@ private:
     public:
         DataExchange(const string& bufferName)
             : Exchange::DataExchange(bufferName)
+            , _lock()
+#ifdef OCDM_SESSION_DECRYPT_CONCURRENCY
+            , _decryptLock(_lock)
+#else
+            , _decryptLock(_systemLock)
+#endif
             , _busy(false)
+            , _statistics()
         {
 
             TRACE_L1("Constructing buffer client side: %p - %s", this,
@@ -575,62 +714,50 @@ private:
             int ret = 0;
 
             // This works, because we know that the Audio and the Video streams are
-            // fed from
-            // the same process, so they will use the same critial section and thus
-            // will
-            // not interfere with each-other. If Audio and video will be located into
-            // two
-            // different processes, start using the administartion space to share a
-            // lock.
-            _systemLock.Lock();
+            // fed from the same process, so they will use the same critial section
+            // and thus will not interfere with each-other. If Audio and video will
+            // be located into two different processes, start using the
+            // administartion space to share a lock.
+            // By default this is the process wide _systemLock, so all sessions
+            // decrypt one sample at a time. With OCDM_SESSION_DECRYPT_CONCURRENCY
+            // only this buffer is serialized and other sessions can have their
+            // decrypts in flight at the same time.
+            // The buffer lock comes first, a sample acquired for in place
+            // decryption holds it until it is released, and only stalls the
+            // callers of this session.
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            _lock.Lock();
+            _decryptLock.Lock();
+
+            uint64_t mark = Record(_statistics.lockWait, start);
 
             _busy = true;
 
             if (RequestProduce(Core::infinite) == Core::ERROR_NONE) {
 
-                CDMi::SubSampleInfo* subSample = nullptr;
-                uint8_t subSampleCount = 0;
-                CDMi::EncryptionScheme encScheme = CDMi::EncryptionScheme::AesCtr_Cenc;
-                CDMi::EncryptionPattern pattern = {0 , 0};
-                uint8_t* ivData = nullptr;
-                uint8_t ivDataLength = 0;
-                uint8_t* keyId = nullptr;
-                uint8_t keyIdLength = 0;
-
-                if(sampleInfo != nullptr) {
-                    subSample = reinterpret_cast<CDMi::SubSampleInfo*>(sampleInfo->subSample);
-                    subSampleCount = sampleInfo->subSampleCount;
-                    ivData = sampleInfo->iv;
-                    ivDataLength = sampleInfo->ivLength;
-                    keyId = sampleInfo->keyId;
-                    keyIdLength = sampleInfo->keyIdLength;
-                    encScheme = static_cast<CDMi::EncryptionScheme>(sampleInfo->scheme);
-                    pattern.clear_blocks = sampleInfo->pattern.clear_blocks;
-                    pattern.encrypted_blocks = sampleInfo->pattern.encrypted_blocks;
-                }
+                Record(_statistics.bufferWait, mark);
 
-                SetIV(static_cast<uint8_t>(ivDataLength), ivData);
-                KeyId(static_cast<uint8_t>(keyIdLength), keyId);
-                SubSample(subSampleCount, subSample);
-                SetEncScheme(static_cast<uint8_t>(encScheme));
-                SetEncPattern(pattern.encrypted_blocks,pattern.clear_blocks);
-                InitWithLast15(initWithLast15);
-                if(properties != nullptr) {
-                    SetMediaProperties(properties->height, properties->width, properties->media_type);
-                }
+                Describe(sampleInfo, initWithLast15, properties);
 
                 Write(encryptedDataLength, encryptedData);
 
                 // This will trigger the OpenCDMIServer to decrypt this memory...
                 Produced();
 
+                mark = Core::Time::Now().Ticks();
+
                 // Now we should wait till it is decrypted, that happens if the
                 // Producer, can run again.
                 if (RequestProduce(Core::infinite) == Core::ERROR_NONE) {
 
+                    mark = Record(_statistics.serverDecrypt, mark);
+
                     // For nowe we just copy the clear data..
                     Read(encryptedDataLength, encryptedData);
 
+                    Throughput(properties, encryptedDataLength, start, Record(_statistics.copyBack, mark));
+
                     // Get the status of the last decrypt.
                     ret = Status();
 
@@ -641,13 +768,488 @@ private:
 
             _busy = false;
 
-            _systemLock.Unlock();
+            _decryptLock.Unlock();
+            _lock.Unlock();
 
             return (ret);
         }
 
+        // Batch variant of Decrypt(). The locks and the producer side of the
+        // buffer are taken once and only handed back after the last sample:
+        // once the server decrypted a sample the producer owns the buffer
+        // again, so the next sample can be written straight away. Every
+        // sample is still a Produced()/RequestProduce() round trip with the
+        // server.
+        uint32_t DecryptBatch(::DecryptSample samples[], const uint32_t count)
+        {
+            uint32_t ret = OpenCDMError::ERROR_NONE;
+            uint32_t index = 0;
+
+            for (; index < count; index++) {
+                samples[index].result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+            }
+
+            const uint64_t waiting = Core::Time::Now().Ticks();
+
+            _lock.Lock();
+            _decryptLock.Lock();
+
+            const uint64_t locked = Record(_statistics.lockWait, waiting);
+
+            _busy = true;
+
+            if (RequestProduce(Core::infinite) != Core::ERROR_NONE) {
+                ret = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+            } else {
+                Record(_statistics.bufferWait, locked);
+
+                for (index = 0; index < count; index++) {
+                    ::DecryptSample& sample = samples[index];
+
+                    if (sample.encryptedLength == 0) {
+                        sample.result = OpenCDMError::ERROR_NONE;
+                    } else {
+                        const uint64_t start = Core::Time::Now().Ticks();
+
+                        Describe(sample.sampleInfo, 0, sample.streamProperties);
+
+                        Write(sample.encryptedLength, sample.encrypted);
+
+                        Produced();
+
+                        uint64_t mark = Core::Time::Now().Ticks();
+
+                        if (RequestProduce(Core::infinite) != Core::ERROR_NONE) {
+                            // We lost the buffer, the rest can not be done.
+                            break;
+                        }
+
+                        mark = Record(_statistics.serverDecrypt, mark);
+
+                        Read(sample.encryptedLength, sample.encrypted);
+
+                        Throughput(sample.streamProperties, sample.encryptedLength, start, Record(_statistics.copyBack, mark));
+
+                        sample.result = (Status() == 0 ? OpenCDMError::ERROR_NONE : OpenCDMError::ERROR_UNKNOWN);
+                    }
+
+                    if ((sample.result != OpenCDMError::ERROR_NONE) && (ret == OpenCDMError::ERROR_NONE)) {
+                        ret = sample.result;
+                    }
+                }
+
+                if (index == count) {
+                    Consumed();
+                } else if (ret == OpenCDMError::ERROR_NONE) {
+                    ret = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+                }
+            }
+
+            _busy = false;
+
+            _decryptLock.Unlock();
+            _lock.Unlock();
+
+            return (ret);
+        }
+
+        // Zero copy variant of Decrypt(). Acquire() hands out the sample area of
+        // the shared buffer so the sample can be written straight into it,
+        // DecryptInPlace() has it decrypted in there and Release() hands the
+        // buffer back for the next sample. All three must be called from the
+        // same thread. Only the lock of this buffer is held from Acquire()
+        // until Release(), the decrypt lock (process wide by default) is
+        // only taken while the server decrypts the sample.
+        uint32_t Acquire(const uint32_t length, uint8_t*& buffer)
+        {
+            uint32_t result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+
+            _lock.Lock();
+
+            if (RequestProduce(Core::infinite) == Core::ERROR_NONE) {
+                if (length > Size()) {
+                    TRACE_L1("Sample of %d bytes does not fit the %d bytes buffer", length, Size());
+                    Consumed();
+                    result = OpenCDMError::ERROR_BUFFER_TOO_SMALL;
+                } else {
+                    _busy = true;
+                    buffer = Buffer();
+                    result = OpenCDMError::ERROR_NONE;
+                }
+            }
+
+            if (result != OpenCDMError::ERROR_NONE) {
+                _lock.Unlock();
+            }
+
+            return (result);
+        }
+        uint32_t DecryptInPlace(const uint32_t length,
+            const ::SampleInfo* sampleInfo,
+            const ::MediaProperties* properties)
+        {
+            uint32_t ret = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+
+            ASSERT(_busy == true);
+            ASSERT(length <= Size());
+
+            if (_busy == true) {
+                const uint64_t start = Core::Time::Now().Ticks();
+
+                _decryptLock.Lock();
+
+                const uint64_t mark = Record(_statistics.lockWait, start);
+
+                Describe(sampleInfo, 0, properties);
+
+                BytesWritten(length);
+
+                Produced();
+
+                // The producer can run again once the server decrypted the
+                // sample, which is now in place in the shared buffer.
+                if (RequestProduce(Core::infinite) == Core::ERROR_NONE) {
+                    Throughput(properties, length, start, Record(_statistics.serverDecrypt, mark));
+
+                    ret = Status();
+                }
+
+                _decryptLock.Unlock();
+            }
+
+            return (ret);
+        }
+        void Release()
+        {
+            ASSERT(_busy == true);
+
+            if (_busy == true) {
+                _busy = false;
+
+                Consumed();
+
+                _lock.Unlock();
+            }
+        }
+
+        void Statistics(::DecryptStats& stats) const
+        {
+            _decryptLock.Lock();
+
+            stats = _statistics;
+
+            _decryptLock.Unlock();
+        }
+
     private:
+        // Records the time passed since "since" and returns the current time,
+        // so the next phase can be measured from there.
+        static uint64_t Record(::DecryptHistogram& histogram, const uint64_t since)
+        {
+            const uint64_t now = Core::Time::Now().Ticks();
+            const uint64_t duration = ((now > since ? now - since : 0) * 1000) / Core::Time::TicksPerMillisecond;
+            uint64_t value = duration;
+            uint8_t bucket = 0;
+
+            while ((value != 0) && (bucket < (OPENCDM_DECRYPT_HISTOGRAM_BUCKETS - 1))) {
+                value >>= 1;
+                bucket++;
+            }
+
+            histogram.buckets[bucket]++;
+            histogram.count++;
+            histogram.total += duration;
+            if (duration > histogram.maximum) {
+                histogram.maximum = static_cast<uint32_t>(std::min(duration, static_cast<uint64_t>(~static_cast<uint32_t>(0))));
+            }
+
+            return (now);
+        }
+        void Throughput(const ::MediaProperties* properties, const uint32_t length, const uint64_t start, const uint64_t end)
+        {
+            if (properties != nullptr) {
+                ::DecryptThroughput* throughput = (properties->media_type == MediaType_Audio ? &_statistics.audio : (properties->media_type == MediaType_Video ? &_statistics.video : nullptr));
+
+                if (throughput != nullptr) {
+                    throughput->bytes += length;
+                    throughput->duration += ((end - start) * 1000) / Core::Time::TicksPerMillisecond;
+                }
+            }
+        }
+        void Describe(const ::SampleInfo* sampleInfo,
+            uint32_t initWithLast15,
+            const ::MediaProperties* properties)
+        {
+            CDMi::SubSampleInfo* subSample = nullptr;
+            uint8_t subSampleCount = 0;
+            CDMi::EncryptionScheme encScheme = CDMi::EncryptionScheme::AesCtr_Cenc;
+            CDMi::EncryptionPattern pattern = {0 , 0};
+            uint8_t* ivData = nullptr;
+            uint8_t ivDataLength = 0;
+            uint8_t* keyId = nullptr;
+            uint8_t keyIdLength = 0;
+
+            if(sampleInfo != nullptr) {
+                subSample = reinterpret_cast<CDMi::SubSampleInfo*>(sampleInfo->subSample);
+                subSampleCount = sampleInfo->subSampleCount;
+                ivData = sampleInfo->iv;
+                ivDataLength = sampleInfo->ivLength;
+                keyId = sampleInfo->keyId;
+                keyIdLength = sampleInfo->keyIdLength;
+                encScheme = static_cast<CDMi::EncryptionScheme>(sampleInfo->scheme);
+                pattern.clear_blocks = sampleInfo->pattern.clear_blocks;
+                pattern.encrypted_blocks = sampleInfo->pattern.encrypted_blocks;
+            }
+
+            SetIV(static_cast<uint8_t>(ivDataLength), ivData);
+            KeyId(static_cast<uint8_t>(keyIdLength), keyId);
+            SubSample(subSampleCount, subSample);
+            SetEncScheme(static_cast<uint8_t>(encScheme));
+            SetEncPattern(pattern.encrypted_blocks,pattern.clear_blocks);
+            InitWithLast15(initWithLast15);
+            if(properties != nullptr) {
+                SetMediaProperties(properties->height, properties->width, properties->media_type);
+            }
+        }
+
+    private:
+        Core::CriticalSection _lock;
+        Core::CriticalSection& _decryptLock;
         bool _busy;
+        ::DecryptStats _statistics;
+    };
+
+    // Ring of sample slots, drained by a worker thread through the (single
+    // slot) DataExchange of the session. The submitter can prepare and queue
+    // the next sample while the server is still working on the previous one.
+    // The sample buffers and the SampleInfo/MediaProperties passed in must
+    // stay valid until the result of the slot has been collected.
+    class DecryptRing : public Core::Thread {
+    public:
+        static constexpr uint8_t Slots = 8;
+
+    private:
+        enum state : uint8_t {
+            EMPTY,
+            QUEUED,
+            DECRYPTED
+        };
+
+        struct Slot {
+            Slot(const Slot&) = delete;
+            Slot& operator=(const Slot&) = delete;
+
+            Slot()
+                : Data(nullptr)
+                , Length(0)
+                , Info(nullptr)
+                , Properties(nullptr)
+                , Ticket(0)
+                , Result(0)
+                , State(EMPTY)
+                , Done(false, true)
+            {
+            }
+            ~Slot() = default;
+
+            uint8_t* Data;
+            uint32_t Length;
+            const ::SampleInfo* Info;
+            const ::MediaProperties* Properties;
+            uint32_t Ticket;
+            uint32_t Result;
+            state State;
+            Core::Event Done;
+        };
+
+    public:
+        DecryptRing() = delete;
+        DecryptRing(const DecryptRing&) = delete;
+        DecryptRing& operator=(const DecryptRing&) = delete;
+
+        DecryptRing(OpenCDMSession& parent)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("OCDMDecrypt"))
+            , _parent(parent)
+            , _lock()
+            , _submitted(false, true)
+            , _head(0)
+            , _tail(0)
+            , _running(true)
+        {
+            Run();
+        }
+        ~DecryptRing() override
+        {
+            _lock.Lock();
+            _running = false;
+            _submitted.SetEvent();
+            _lock.Unlock();
+
+            // Lets the worker finish the sample it is decrypting, if any.
+            Thread::Wait(BLOCKED, Core::infinite);
+
+            // Samples that were still queued will never be decrypted, do not
+            // leave their waiters hanging.
+            _lock.Lock();
+            while (_tail != _head) {
+                Slot& slot = _slots[_tail % Slots];
+                ASSERT(slot.State == QUEUED);
+                slot.Result = OpenCDMError::ERROR_INVALID_SESSION;
+                slot.State = DECRYPTED;
+                slot.Done.SetEvent();
+                _tail++;
+            }
+            _lock.Unlock();
+        }
+
+    public:
+        uint32_t Submit(uint8_t* data, const uint32_t length, const ::SampleInfo* sampleInfo,
+            const ::MediaProperties* properties, uint32_t& ticket)
+        {
+            // A full ring is back pressure, not an error of the sample.
+            uint32_t result = OpenCDMError::ERROR_INPROGRESS;
+
+            _lock.Lock();
+
+            Slot& slot = _slots[_head % Slots];
+
+            if (_running == false) {
+                result = OpenCDMError::ERROR_INVALID_SESSION;
+            } else if (slot.State == EMPTY) {
+                slot.Data = data;
+                slot.Length = length;
+                slot.Info = sampleInfo;
+                slot.Properties = properties;
+                slot.Ticket = _head;
+                slot.Result = 0;
+                slot.State = QUEUED;
+                slot.Done.ResetEvent();
+
+                ticket = _head++;
+
+                _submitted.SetEvent();
+                result = OpenCDMError::ERROR_NONE;
+            }
+
+            _lock.Unlock();
+
+            return (result);
+        }
+        uint32_t Collect(const uint32_t ticket, const uint32_t waitTime)
+        {
+            uint32_t result = OpenCDMError::ERROR_INVALID_ARG;
+            Slot& slot = _slots[ticket % Slots];
+
+            _lock.Lock();
+            bool valid = ((slot.State != EMPTY) && (slot.Ticket == ticket));
+            _lock.Unlock();
+
+            if (valid == true) {
+                if (slot.Done.Lock(waitTime) != Core::ERROR_NONE) {
+                    result = OpenCDMError::ERROR_TIMED_OUT;
+                } else {
+                    _lock.Lock();
+                    result = slot.Result;
+                    slot.State = EMPTY;
+                    _lock.Unlock();
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            Slot* slot = nullptr;
+
+            _lock.Lock();
+
+            if (_running == false) {
+                _lock.Unlock();
+                Thread::Block();
+                return (Core::infinite);
+            }
+
+            if (_tail != _head) {
+                slot = &(_slots[_tail % Slots]);
+                ASSERT(slot->State == QUEUED);
+                _tail++;
+            } else {
+                _submitted.ResetEvent();
+            }
+
+            _lock.Unlock();
+
+            if (slot == nullptr) {
+                _submitted.Lock(Core::infinite);
+            } else {
+                uint32_t result = _parent.Decrypt(slot->Data, slot->Length, slot->Info, 0, slot->Properties);
+
+                _lock.Lock();
+                slot->Result = result;
+                slot->State = DECRYPTED;
+                _lock.Unlock();
+
+                slot->Done.SetEvent();
+            }
+
+            return (0);
+        }
+
+    private:
+        OpenCDMSession& _parent;
+        Core::CriticalSection _lock;
+        Core::Event _submitted;
+        Slot _slots[Slots];
+        uint32_t _head;
+        uint32_t _tail;
+        bool _running;
+    };
+
+    // Milliseconds from constructing the session until each of the steps
+    // towards the first decrypted sample, to see where time to first frame
+    // goes. Every phase is only recorded the first time it is reached.
+    class Startup {
+    public:
+        enum phase : uint8_t {
+            CREATED,
+            BUFFER,
+            KEY,
+            DECRYPT,
+            PHASES
+        };
+
+    public:
+        Startup(const Startup&) = delete;
+        Startup& operator=(const Startup&) = delete;
+
+        Startup()
+            : _start(Core::Time::Now().Ticks())
+        {
+            for (uint8_t index = 0; index < PHASES; index++) {
+                _phases[index] = Pending;
+            }
+        }
+        ~Startup() = default;
+
+    public:
+        bool Mark(const phase step)
+        {
+            uint32_t expected = Pending;
+
+            return (_phases[step].compare_exchange_strong(expected, static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / Core::Time::TicksPerMillisecond)));
+        }
+        uint32_t Elapsed(const phase step) const
+        {
+            return (_phases[step]);
+        }
+
+    private:
+        static constexpr uint32_t Pending = ~0;
+
+        const uint64_t _start;
+        std::atomic<uint32_t> _phases[PHASES];
     };
 
 public:
@@ -667,6 +1269,7 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         void* userData)
         : _sessionId()
         , _decryptSession(nullptr)
+        , _decryptRing(nullptr)
         , _session(nullptr)
         , _sessionExt(nullptr)
         , _refCount(1)
@@ -674,12 +1277,15 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         , _URL()
         , _callback(callbacks)
         , _userData(userData)
-        , _keyStatuses()
+        , _keyLock()
+        , _keys(std::make_shared<KeySnapshot>())
         , _error()
         , _errorCode(~0)
         , _sysError(Exchange::OCDM_RESULT::OCDM_SUCCESS)
         , _system(system)
         , _pvtData(nullptr)
+        , _decryptAttached(false, true)
+        , _startup()
     {
         std::string bufferId;
         Exchange::ISession* realSession = nullptr;
@@ -693,14 +1299,23 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         if (realSession == nullptr) {
             TRACE_L1("Creating a Session failed. %d", __LINE__);
         } else {
+            _startup.Mark(Startup::CREATED);
             Session(realSession);
             realSession->Release();
             OpenCDMAccessor::Instance()->AddSession(this);
+#ifdef OCDM_SESSION_BUFFER_PREWARM
+            // Have the buffer attached in the background while the license
+            // is being acquired, instead of on the first decrypt.
+            Prewarm(this);
+#endif
         }
     }
 
     virtual ~OpenCDMSession();
 
+private:
+    static void Prewarm(OpenCDMSession* session);
+
 POP_WARNING()
 
 public:
@@ -743,19 +1358,19 @@ public:
     }
     inline Exchange::ISession::KeyStatus Status(const uint8_t keyIDLength, const uint8_t keyId[]) const
     {
-        Exchange::KeyId key(keyId, keyIDLength);
+        const std::shared_ptr<const KeySnapshot> keys(std::atomic_load(&_keys));
+        const KeySnapshot::Entry* entry = keys->Find(keyIDLength, keyId);
 
-        KeyStatusesMap::const_iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
-
-        return index != _keyStatuses.end() ? index->Status() : Exchange::ISession::StatusPending;
+        return (entry != nullptr ? entry->Status : Exchange::ISession::StatusPending);
+    }
+    template <typename ACTION>
+    void KeyStatuses(ACTION&& action) const
+    {
+        std::atomic_load(&_keys)->Visit(action);
     }
     inline bool HasKeyId(const uint8_t keyIDLength, const uint8_t keyID[]) const
     {
-        Exchange::KeyId key(keyID, keyIDLength);
-
-        KeyStatusesMap::const_iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
-
-        return (index != _keyStatuses.end());
+        return (std::atomic_load(&_keys)->Find(keyIDLength, keyID) != nullptr);
     }
     inline void Close()
     {
@@ -817,10 +1432,126 @@ public:
                 TRACE_L1("Decrypt() failed with return code: %x", result);
                 result = OpenCDMError::ERROR_UNKNOWN;
             }
+            else if (_startup.Mark(Startup::DECRYPT) == true) {
+                TRACE_L1("Session %s startup [ms]: created %d, buffer %d, key %d, first sample %d", _sessionId.c_str(),
+                    _startup.Elapsed(Startup::CREATED), _startup.Elapsed(Startup::BUFFER),
+                    _startup.Elapsed(Startup::KEY), _startup.Elapsed(Startup::DECRYPT));
+            }
         }
         return (result);
     }
 
+    uint32_t DecryptBatch(::DecryptSample samples[], const uint32_t count)
+    {
+        uint32_t result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+
+        // lazy create decryptbuffer
+        if(_decryptSession == nullptr) {
+            DecryptSession(_session);
+        }
+
+        DataExchange* decryptSession = _decryptSession;
+
+        if (decryptSession != nullptr) {
+            result = decryptSession->DecryptBatch(samples, count);
+            if(result)
+            {
+                TRACE_L1("DecryptBatch() failed with return code: %x", result);
+            }
+        } else {
+            for (uint32_t index = 0; index < count; index++) {
+                samples[index].result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+            }
+        }
+        return (result);
+    }
+
+    void DecryptStatistics(::DecryptStats& stats) const
+    {
+        DataExchange* decryptSession = _decryptSession;
+
+        if (decryptSession != nullptr) {
+            decryptSession->Statistics(stats);
+        } else {
+            ::memset(&stats, 0, sizeof(stats));
+        }
+    }
+
+    uint32_t DecryptAcquire(const uint32_t length, uint8_t*& buffer)
+    {
+        uint32_t result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+
+        // lazy create decryptbuffer
+        if(_decryptSession == nullptr) {
+            DecryptSession(_session);
+        }
+
+        DataExchange* decryptSession = _decryptSession;
+
+        if (decryptSession != nullptr) {
+            result = decryptSession->Acquire(length, buffer);
+        }
+        return (result);
+    }
+
+    uint32_t DecryptInPlace(const uint32_t length,
+        const ::SampleInfo* sampleInfo,
+        const ::MediaProperties* properties)
+    {
+        uint32_t result = OpenCDMError::ERROR_INVALID_DECRYPT_BUFFER;
+
+        DataExchange* decryptSession = _decryptSession;
+
+        if (decryptSession != nullptr) {
+            result = decryptSession->DecryptInPlace(length, sampleInfo, properties);
+            if(result)
+            {
+                TRACE_L1("DecryptInPlace() failed with return code: %x", result);
+                result = OpenCDMError::ERROR_UNKNOWN;
+            }
+        }
+        return (result);
+    }
+
+    void DecryptRelease()
+    {
+        DataExchange* decryptSession = _decryptSession;
+
+        if (decryptSession != nullptr) {
+            decryptSession->Release();
+        }
+    }
+
+    uint32_t DecryptSubmit(uint8_t* encryptedData, const uint32_t encryptedDataLength,
+        const ::SampleInfo* sampleInfo,
+        const ::MediaProperties* properties,
+        uint32_t& ticket)
+    {
+        // lazy create the ring and its worker on first use
+        if (_decryptRing == nullptr) {
+            _systemLock.Lock();
+            if (_decryptRing == nullptr) {
+                _decryptRing = new DecryptRing(*this);
+            }
+            _systemLock.Unlock();
+        }
+
+        return (_decryptRing.load()->Submit(encryptedData, encryptedDataLength, sampleInfo, properties, ticket));
+    }
+
+    uint32_t DecryptWait(const uint32_t ticket, const uint32_t waitTime)
+    {
+        uint32_t result = OpenCDMError::ERROR_INVALID_ARG;
+
+        DecryptRing* decryptRing = _decryptRing;
+
+        if (decryptRing != nullptr) {
+            result = decryptRing->Collect(ticket, waitTime);
+        }
+
+        return (result);
+    }
+
     void* SessionPrivateData() const
     {
         return _pvtData;
@@ -886,6 +1617,14 @@ public:
 
     bool BelongsTo(OpenCDMSystem* system) { return system == _system; }
 
+    // Attaches the session buffer if that did not happen yet.
+    void AttachBuffer()
+    {
+        if ((_decryptSession == nullptr) && (_session != nullptr)) {
+            DecryptSession(_session);
+        }
+    }
+
 protected:
     void Session(Exchange::ISession* session)
     {
@@ -925,15 +1664,18 @@ protected:
             if( result == 0 ) {
                 ASSERT (_decryptSession == nullptr);
                 _decryptSession = new DataExchange(bufferid); 
+                _startup.Mark(Startup::BUFFER);
+                _decryptAttached.SetEvent();
             }
             else if ( result == 1 ) {
-                while( _decryptSession == nullptr ) {
-                    SleepMs(0);
-                }
+                // Someone else is attaching the buffer, wait till it is there.
+                _decryptAttached.Lock(Core::infinite);
             }
             else {
                 ASSERT (_decryptSession == nullptr);
                 TRACE_L1("DecryptSession could not be created!");
+                // Do not leave the ones waiting for it hanging.
+                _decryptAttached.SetEvent();
             }
         }
     }
@@ -963,16 +1705,20 @@ protected:
     // Event fired on key status update
     void OnKeyStatusUpdate(const uint8_t keyID[], const uint8_t keyIDLength, const Exchange::ISession::KeyStatus status)
     {   
-        Exchange::KeyId key(keyID, keyIDLength);
+        _keyLock.Lock();
 
-        KeyStatusesMap::iterator index = std::find(_keyStatuses.begin(), _keyStatuses.end(), key);
+        // A reader holds its own reference on the snapshot it picked up, the
+        // previous one goes as soon as the last of those readers is done.
+        const std::shared_ptr<const KeySnapshot> current(std::atomic_load(&_keys));
 
-        if (index == _keyStatuses.end()) {
-            key.Status(status);
-            _keyStatuses.emplace_back(key);
-        }
-        else {
-            index->Status(status);
+        std::atomic_store(&_keys, std::shared_ptr<const KeySnapshot>(std::make_shared<KeySnapshot>(*current, keyIDLength, keyID, status)));
+
+        _keyLock.Unlock();
+
+        OpenCDMAccessor::Instance()->KeyUpdate(this, keyIDLength, keyID, status);
+
+        if (status == Exchange::ISession::Usable) {
+            _startup.Mark(Startup::KEY);
         }
 
         if ((_callback != nullptr) && (_callback->key_update_callback != nullptr) && (status != Exchange::ISession::StatusPending)) {
@@ -990,6 +1736,7 @@ protected:
 private:
     std::string _sessionId;
     std::atomic<DataExchange*> _decryptSession;
+    std::atomic<DecryptRing*> _decryptRing;
     Exchange::ISession* _session;
     Exchange::ISessionExt* _sessionExt;
     uint32_t _refCount;
@@ -997,11 +1744,14 @@ private:
     std::string _URL;
     OpenCDMSessionCallbacks* _callback;
     void* _userData; 
-    KeyStatusesMap _keyStatuses;
+    Core::CriticalSection _keyLock;
+    std::shared_ptr<const KeySnapshot> _keys;
     std::string _error;
     uint32_t _errorCode;
     Exchange::OCDM_RESULT _sysError;
     OpenCDMSystem* _system;
     void* _pvtData;
+    Core::Event _decryptAttached;
+    Startup _startup;
 };
 
@@ -0,0 +1,103 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME CapsParserBench
+#endif
+
+#include "ClearKeyFixture.h"
+#include "BaselineCapsParser.h"
+
+#include <ocdm/CapsParser.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace Thunder;
+using namespace OCDMTest;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    const char VideoCaps[] = "video/x-h264, stream-format=(string)avc, alignment=(string)au, level=(string)4.1, profile=(string)high, "
+                             "codec_data=(buffer)0164002affe1001a6764002aacd940780227e5c044000003000400000300c83c60c65801000568ebecb22c, "
+                             "width=(int)1920, height=(int)1080, framerate=(fraction)24000/1001, pixel-aspect-ratio=(fraction)1/1, "
+                             "original-media-type=(string)video/x-h264, protection-system=(string)edef8ba9-79d6-4ace-a3c8-27dcd51d21ed";
+
+    const char AudioCaps[] = "audio/mpeg, mpegversion=(int)4, framed=(boolean)true, stream-format=(string)raw, level=(string)2, "
+                             "base-profile=(string)lc, profile=(string)lc, codec_data=(buffer)1190, rate=(int)48000, channels=(int)2, "
+                             "original-media-type=(string)audio/mpeg, protection-system=(string)edef8ba9-79d6-4ace-a3c8-27dcd51d21ed";
+
+    // Runs the same caps through a parser over and over, and alternates
+    // video and audio caps, which defeats the hash check of the baseline.
+    template <typename PARSER>
+    void Run(const char name[], const uint32_t iterations, PARSER& parser, volatile uint32_t& sink)
+    {
+        uint32_t index = 0;
+
+        cout << name << endl;
+
+        Repeat("  video:      ", iterations, [&]() {
+            parser.Parse(reinterpret_cast<const uint8_t*>(VideoCaps), sizeof(VideoCaps) - 1);
+            sink += parser.GetWidth() + parser.GetHeight();
+        });
+        Repeat("  audio:      ", iterations, [&]() {
+            parser.Parse(reinterpret_cast<const uint8_t*>(AudioCaps), sizeof(AudioCaps) - 1);
+            sink += parser.GetWidth() + parser.GetHeight();
+        });
+        Repeat("  alternating:", iterations, [&]() {
+            if ((index++ & 1) == 0) {
+                parser.Parse(reinterpret_cast<const uint8_t*>(VideoCaps), sizeof(VideoCaps) - 1);
+            } else {
+                parser.Parse(reinterpret_cast<const uint8_t*>(AudioCaps), sizeof(AudioCaps) - 1);
+            }
+            sink += parser.GetWidth() + parser.GetHeight();
+        });
+    }
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    cout << "[iterations, default 1000000]" << endl;
+
+    const uint32_t iterations = (argc > 1 ? atoi(argv[1]) : 1000000);
+
+    if (iterations == 0) {
+        cout << "invalid args" << endl;
+        return -1;
+    }
+
+    Plugin::CapsParser parser;
+    Baseline::CapsParser baseline;
+    volatile uint32_t sink = 0;
+
+    parser.Parse(reinterpret_cast<const uint8_t*>(VideoCaps), sizeof(VideoCaps) - 1);
+    cout << "video: " << parser.GetWidth() << "x" << parser.GetHeight() << " type " << static_cast<uint32_t>(parser.GetMediaType()) << endl;
+    parser.Parse(reinterpret_cast<const uint8_t*>(AudioCaps), sizeof(AudioCaps) - 1);
+    cout << "audio: " << parser.GetWidth() << "x" << parser.GetHeight() << " type " << static_cast<uint32_t>(parser.GetMediaType()) << endl;
+
+    Run("baseline:", iterations, baseline, sink);
+    Run("parser:", iterations, parser, sink);
+
+    cout << "checksum: " << sink << endl;
+
+    return 0;
+}
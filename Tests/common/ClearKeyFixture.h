@@ -0,0 +1,160 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Define MODULE_NAME before including this header, it pulls in core.
+
+#include <ocdm/open_cdm.h>
+
+#include <core/core.h>
+#include <iostream>
+
+namespace OCDMTest {
+
+    // ClearKey key/keyid pair, the license is pushed straight into the
+    // session without a round trip to a license server.
+    const uint8_t KeyId[] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F };
+    const uint8_t Key[] = { 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF };
+    const uint8_t IV[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    const char InitData[] = "{\"kids\":[\"EBESExQVFhcYGRobHB0eHw\"]}";
+    const char License[] = "{\"keys\":[{\"kty\":\"oct\",\"kid\":\"EBESExQVFhcYGRobHB0eHw\",\"k\":\"oKGio6SlpqeoqaqrrK2urw\"}],\"type\":\"temporary\"}";
+
+    constexpr uint32_t KeyWaitTime = 2000;
+
+    inline void OnChallenge(struct OpenCDMSession*, void*, const char[], const uint8_t[], const uint16_t)
+    {
+    }
+
+    inline OpenCDMSessionCallbacks* Callbacks()
+    {
+        static OpenCDMSessionCallbacks callbacks = { OnChallenge, nullptr, nullptr, nullptr };
+
+        return (&callbacks);
+    }
+
+    inline bool WaitForKey(const struct OpenCDMSession* session)
+    {
+        uint64_t timeOut(Thunder::Core::Time::Now().Add(KeyWaitTime).Ticks());
+
+        while ((opencdm_session_status(session, KeyId, sizeof(KeyId)) != Usable) && (Thunder::Core::Time::Now().Ticks() < timeOut)) {
+            SleepMs(10);
+        }
+
+        return (opencdm_session_status(session, KeyId, sizeof(KeyId)) == Usable);
+    }
+
+    // Session on the ClearKey license above, nullptr if it could not be
+    // created or the key did not become usable in time.
+    inline struct OpenCDMSession* OpenSession(struct OpenCDMSystem* system)
+    {
+        struct OpenCDMSession* session = nullptr;
+
+        if ((opencdm_construct_session(system, Temporary, "keyids", reinterpret_cast<const uint8_t*>(InitData), sizeof(InitData) - 1,
+                 nullptr, 0, Callbacks(), nullptr, &session) != ERROR_NONE) || (session == nullptr)) {
+            std::cout << "ocdm session could not be created" << std::endl;
+            session = nullptr;
+        } else {
+            opencdm_session_update(session, reinterpret_cast<const uint8_t*>(License), sizeof(License) - 1);
+
+            if (WaitForKey(session) == false) {
+                std::cout << "key did not become usable" << std::endl;
+                opencdm_destruct_session(session);
+                session = nullptr;
+            }
+        }
+
+        return (session);
+    }
+
+    class Stopwatch {
+    public:
+        Stopwatch(const Stopwatch&) = delete;
+        Stopwatch& operator=(const Stopwatch&) = delete;
+
+        Stopwatch()
+            : _start(Thunder::Core::Time::Now().Ticks())
+        {
+        }
+        ~Stopwatch() = default;
+
+    public:
+        uint64_t Microseconds() const
+        {
+            return (((Thunder::Core::Time::Now().Ticks() - _start) * 1000) / Thunder::Core::Time::TicksPerMillisecond);
+        }
+        double Seconds() const
+        {
+            return (static_cast<double>(Microseconds()) / 1000000.0);
+        }
+
+    private:
+        const uint64_t _start;
+    };
+
+    inline uint64_t Deadline(const uint32_t seconds)
+    {
+        return (Thunder::Core::Time::Now().Add(seconds * 1000).Ticks());
+    }
+
+    inline void Report(const std::string& name, const uint64_t samples, const uint32_t failures, const uint32_t sampleSize, const double seconds)
+    {
+        const double rate = samples / seconds;
+
+        std::cout << name
+                  << " samples/s: " << static_cast<uint64_t>(rate)
+                  << " MB/s: " << (rate * sampleSize) / (1024.0 * 1024.0)
+                  << " failures: " << failures << std::endl;
+    }
+
+    // Calls decrypt back to back for the given time and reports its rate.
+    template <typename DECRYPT>
+    void Measure(const char name[], const uint32_t sampleSize, const uint32_t seconds, DECRYPT&& decrypt)
+    {
+        uint64_t samples = 0;
+        uint32_t failures = 0;
+
+        const Stopwatch stopwatch;
+        const uint64_t deadline = Deadline(seconds);
+
+        while (Thunder::Core::Time::Now().Ticks() < deadline) {
+            if (decrypt() == ERROR_NONE) {
+                samples++;
+            } else {
+                failures++;
+            }
+        }
+
+        Report(name, samples, failures, sampleSize, stopwatch.Seconds());
+    }
+
+    // Calls action the given number of times and reports the time per call.
+    template <typename ACTION>
+    void Repeat(const char name[], const uint32_t iterations, ACTION&& action)
+    {
+        const Stopwatch stopwatch;
+
+        for (uint32_t index = 0; index < iterations; index++) {
+            action();
+        }
+
+        std::cout << name << " ns/call: " << (stopwatch.Microseconds() * 1000) / iterations << std::endl;
+    }
+
+} // namespace OCDMTest
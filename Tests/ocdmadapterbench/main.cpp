@@ -0,0 +1,245 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME OpenCDMAdapterBench
+#endif
+
+#include <gst/gst.h>
+#include <gst/base/gstbytereader.h>
+
+#include "ClearKeyFixture.h"
+
+#include <ocdm/adapter/open_cdm_adapter.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace Thunder;
+using namespace OCDMTest;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    GstBuffer* CreateBuffer(const uint32_t size, const uint8_t data[])
+    {
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+
+        if (data != nullptr) {
+            gst_buffer_fill(buffer, 0, data, size);
+        } else {
+            gst_buffer_memset(buffer, 0, 0xA5, size);
+        }
+
+        return (buffer);
+    }
+
+    // Synthetic CENC subsample table: every subsample has "clear" bytes in
+    // the clear, the rest of the sample is divided over the encrypted ranges.
+    GstBuffer* CreateSubSamples(const uint32_t sampleSize, const uint32_t count, const uint16_t clear)
+    {
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, count * 6, nullptr);
+        GstMapInfo map;
+
+        gst_buffer_map(buffer, &map, GST_MAP_WRITE);
+
+        const uint32_t encrypted = (sampleSize / count) - clear;
+
+        for (uint32_t index = 0; index < count; index++) {
+            const uint32_t chunk = (index == (count - 1) ? (sampleSize - (index * (clear + encrypted)) - clear) : encrypted);
+            uint8_t* entry = &(map.data[index * 6]);
+
+            entry[0] = static_cast<uint8_t>(clear >> 8);
+            entry[1] = static_cast<uint8_t>(clear);
+            entry[2] = static_cast<uint8_t>(chunk >> 24);
+            entry[3] = static_cast<uint8_t>(chunk >> 16);
+            entry[4] = static_cast<uint8_t>(chunk >> 8);
+            entry[5] = static_cast<uint8_t>(chunk);
+        }
+
+        gst_buffer_unmap(buffer, &map);
+
+        return (buffer);
+    }
+
+    // Sample with its protection meta attached, the way a demuxer hands it
+    // to the decryptor. The meta holds its own references on the buffers.
+    GstBuffer* CreateProtectedBuffer(const uint32_t sampleSize, GstBuffer* subSamples, const uint32_t subSampleCount, GstBuffer* iv, GstBuffer* keyId)
+    {
+        GstBuffer* buffer = CreateBuffer(sampleSize, nullptr);
+        GstStructure* info = gst_structure_new("application/x-cenc",
+            "iv", GST_TYPE_BUFFER, iv,
+            "kid", GST_TYPE_BUFFER, keyId,
+            "subsample_count", G_TYPE_UINT, subSampleCount,
+            "subsamples", GST_TYPE_BUFFER, subSamples,
+            nullptr);
+
+        gst_buffer_add_protection_meta(buffer, info);
+
+        return (buffer);
+    }
+
+    // The adapter implementation as it was: the subsample table is walked
+    // three times, the encrypted ranges are gathered into a freshly allocated
+    // buffer, decrypted and scattered back.
+    OpenCDMError GatherScatter(struct OpenCDMSession* session, GstBuffer* buffer, GstBuffer* subSampleBuffer, const uint32_t subSampleCount)
+    {
+        OpenCDMError result;
+        GstMapInfo dataMap;
+        GstMapInfo sampleMap;
+
+        gst_buffer_map(buffer, &dataMap, GST_MAP_READWRITE);
+        gst_buffer_map(subSampleBuffer, &sampleMap, GST_MAP_READ);
+
+        uint8_t* mappedData = reinterpret_cast<uint8_t*>(dataMap.data);
+        GstByteReader* reader = gst_byte_reader_new(sampleMap.data, sampleMap.size);
+        uint16_t inClear = 0;
+        uint32_t inEncrypted = 0;
+        uint32_t totalEncrypted = 0;
+
+        for (uint32_t position = 0; position < subSampleCount; position++) {
+            gst_byte_reader_get_uint16_be(reader, &inClear);
+            gst_byte_reader_get_uint32_be(reader, &inEncrypted);
+            totalEncrypted += inEncrypted;
+        }
+        gst_byte_reader_set_pos(reader, 0);
+
+        uint8_t* encryptedData = reinterpret_cast<uint8_t*>(malloc(totalEncrypted));
+        uint8_t* encryptedDataIter = encryptedData;
+        uint32_t index = 0;
+
+        for (uint32_t position = 0; position < subSampleCount; position++) {
+            gst_byte_reader_get_uint16_be(reader, &inClear);
+            gst_byte_reader_get_uint32_be(reader, &inEncrypted);
+            memcpy(encryptedDataIter, mappedData + index + inClear, inEncrypted);
+            index += inClear + inEncrypted;
+            encryptedDataIter += inEncrypted;
+        }
+        gst_byte_reader_set_pos(reader, 0);
+
+        result = opencdm_session_decrypt(session, encryptedData, totalEncrypted, AesCtr_Cenc, { 0, 0 }, IV, sizeof(IV), KeyId, sizeof(KeyId), 0);
+
+        index = 0;
+        uint32_t total = 0;
+        for (uint32_t position = 0; position < subSampleCount; position++) {
+            gst_byte_reader_get_uint16_be(reader, &inClear);
+            gst_byte_reader_get_uint32_be(reader, &inEncrypted);
+            memcpy(mappedData + total + inClear, encryptedData + index, inEncrypted);
+            index += inEncrypted;
+            total += inClear + inEncrypted;
+        }
+
+        gst_byte_reader_free(reader);
+        free(encryptedData);
+        gst_buffer_unmap(subSampleBuffer, &sampleMap);
+        gst_buffer_unmap(buffer, &dataMap);
+
+        return (result);
+    }
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    cout << "<keysystem> [sample size, default 65536] [subsamples, default 16] [clear bytes, default 128] [seconds, default 5]" << endl;
+
+    if (argc < 2) {
+        cout << "invalid args" << endl;
+        return -1;
+    }
+
+    const uint32_t sampleSize = (argc > 2 ? atoi(argv[2]) : 65536);
+    const uint32_t subSampleCount = (argc > 3 ? atoi(argv[3]) : 16);
+    const uint16_t clear = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 128);
+    const uint32_t seconds = (argc > 5 ? atoi(argv[5]) : 5);
+
+    if ((subSampleCount == 0) || (subSampleCount > 255) || ((sampleSize / subSampleCount) <= clear)) {
+        cout << "invalid subsample layout" << endl;
+        return -1;
+    }
+
+    gst_init(nullptr, nullptr);
+
+    struct OpenCDMSystem* system = opencdm_create_system(argv[1]);
+
+    if (system == nullptr) {
+        cout << "ocdm system could not be created" << endl;
+        return -1;
+    }
+
+    struct OpenCDMSession* session = OpenSession(system);
+    int result = 0;
+
+    if (session != nullptr) {
+        GstBuffer* buffer = CreateBuffer(sampleSize, nullptr);
+        GstBuffer* subSamples = CreateSubSamples(sampleSize, subSampleCount, clear);
+        GstBuffer* iv = CreateBuffer(sizeof(IV), IV);
+        GstBuffer* keyId = CreateBuffer(sizeof(KeyId), KeyId);
+
+        cout << "sample: " << sampleSize << " bytes, " << subSampleCount << " subsamples, " << clear << " clear bytes each" << endl;
+
+        Measure("gather/scatter:", sampleSize, seconds, [&]() {
+            return (GatherScatter(session, buffer, subSamples, subSampleCount));
+        });
+        Measure("subsample map: ", sampleSize, seconds, [&]() {
+            return (opencdm_gstreamer_session_decrypt(session, buffer, subSamples, subSampleCount, iv, keyId, 0));
+        });
+
+        GstBuffer* protectedBuffer = CreateProtectedBuffer(sampleSize, subSamples, subSampleCount, iv, keyId);
+        GstCaps* caps = gst_caps_from_string("video/x-h264, width=(int)3840, height=(int)2160, original-media-type=(string)video/x-h264");
+
+        // The first buffer sizes the tables of the session and parses the
+        // caps, from there on the adapter should not touch the heap.
+        opencdm_gstreamer_session_decrypt_buffer(session, protectedBuffer, caps);
+
+        const uint64_t allocations = opencdm_gstreamer_session_allocations(session);
+        uint64_t buffers = 0;
+
+        Measure("protection meta:", sampleSize, seconds, [&]() {
+            buffers++;
+            return (opencdm_gstreamer_session_decrypt_buffer(session, protectedBuffer, caps));
+        });
+
+        const uint64_t steady = opencdm_gstreamer_session_allocations(session) - allocations;
+
+        cout << "allocations per buffer: " << (buffers > 0 ? static_cast<double>(steady) / buffers : 0.0)
+             << " (" << steady << " in " << buffers << " buffers)" << endl;
+
+        if (steady != 0) {
+            cout << "the adapter allocated while decrypting in a steady state" << endl;
+            result = 1;
+        }
+
+        gst_caps_unref(caps);
+        gst_buffer_unref(protectedBuffer);
+
+        gst_buffer_unref(keyId);
+        gst_buffer_unref(iv);
+        gst_buffer_unref(subSamples);
+        gst_buffer_unref(buffer);
+
+        opencdm_destruct_session(session);
+    }
+
+    opencdm_destruct_system(system);
+    opencdm_dispose();
+
+    return (result);
+}
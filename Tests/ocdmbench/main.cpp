@@ -0,0 +1,607 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME OpenCDMBench
+#endif
+
+#include "ClearKeyFixture.h"
+
+#include <com/com.h>
+#include <interfaces/IOCDM.h>
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace Thunder;
+using namespace OCDMTest;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    // Every session of the fake server knows about the fixture key only.
+    constexpr uint32_t BufferSize = 4 * 1024 * 1024;
+    constexpr uint32_t AESBlockSize = 16;
+
+    // Clear key decryption of a sample in place, the way a DRM system would
+    // do it for "cenc" (one AES-CTR stream over all encrypted ranges) and
+    // "cbcs" (AES-CBC over the pattern, IV restarted every subsample).
+    class ClearKey {
+    public:
+        ClearKey(const ClearKey&) = delete;
+        ClearKey& operator=(const ClearKey&) = delete;
+
+        ClearKey()
+            : _ctr(EVP_CIPHER_CTX_new())
+            , _cbc(EVP_CIPHER_CTX_new())
+        {
+            EVP_DecryptInit_ex(_ctr, EVP_aes_128_ctr(), nullptr, Key, nullptr);
+            EVP_DecryptInit_ex(_cbc, EVP_aes_128_cbc(), nullptr, Key, nullptr);
+            EVP_CIPHER_CTX_set_padding(_cbc, 0);
+        }
+        ~ClearKey()
+        {
+            EVP_CIPHER_CTX_free(_cbc);
+            EVP_CIPHER_CTX_free(_ctr);
+        }
+
+    public:
+        uint32_t Decrypt(const CDMi::EncryptionScheme scheme, const CDMi::EncryptionPattern& pattern,
+            const uint8_t ivLength, const uint8_t iv[],
+            const uint16_t subSampleCount, const CDMi::SubSampleInfo subSamples[],
+            const uint32_t length, uint8_t data[])
+        {
+            uint8_t fullIV[AESBlockSize] = {};
+            ::memcpy(fullIV, iv, std::min(static_cast<uint32_t>(ivLength), AESBlockSize));
+
+            const CDMi::SubSampleInfo whole = { 0, length };
+            const CDMi::SubSampleInfo* ranges = (subSampleCount == 0 ? &whole : subSamples);
+            const uint16_t count = (subSampleCount == 0 ? 1 : subSampleCount);
+            uint32_t result = Core::ERROR_NONE;
+            uint32_t offset = 0;
+
+            if (scheme == CDMi::EncryptionScheme::AesCtr_Cenc) {
+                EVP_DecryptInit_ex(_ctr, nullptr, nullptr, nullptr, fullIV);
+            }
+
+            for (uint16_t index = 0; (index < count) && (result == Core::ERROR_NONE); index++) {
+                offset += ranges[index].clear_bytes;
+
+                if ((offset + ranges[index].encrypted_bytes) > length) {
+                    result = Core::ERROR_INVALID_RANGE;
+                } else if (scheme == CDMi::EncryptionScheme::AesCtr_Cenc) {
+                    int out = 0;
+                    EVP_DecryptUpdate(_ctr, &data[offset], &out, &data[offset], ranges[index].encrypted_bytes);
+                } else if (scheme == CDMi::EncryptionScheme::AesCbc_Cbcs) {
+                    Pattern(pattern, fullIV, ranges[index].encrypted_bytes, &data[offset]);
+                } else if (scheme != CDMi::EncryptionScheme::Clear) {
+                    result = Core::ERROR_NOT_SUPPORTED;
+                }
+
+                offset += ranges[index].encrypted_bytes;
+            }
+
+            return (result);
+        }
+
+    private:
+        void Pattern(const CDMi::EncryptionPattern& pattern, const uint8_t iv[], const uint32_t length, uint8_t data[])
+        {
+            // No pattern means every (complete) block is encrypted.
+            const uint32_t crypt = (pattern.encrypted_blocks == 0 ? 1 : pattern.encrypted_blocks) * AESBlockSize;
+            const uint32_t skip = pattern.clear_blocks * AESBlockSize;
+            uint32_t offset = 0;
+            int out = 0;
+
+            EVP_DecryptInit_ex(_cbc, nullptr, nullptr, nullptr, iv);
+
+            while ((offset + AESBlockSize) <= length) {
+                const uint32_t chunk = std::min(crypt, (length - offset) & ~(AESBlockSize - 1));
+
+                EVP_DecryptUpdate(_cbc, &data[offset], &out, &data[offset], chunk);
+
+                offset += chunk + skip;
+            }
+        }
+
+    private:
+        EVP_CIPHER_CTX* _ctr;
+        EVP_CIPHER_CTX* _cbc;
+    };
+
+    // Server side of the session buffer: waits for a sample, decrypts it in
+    // place and hands the buffer back, just like OpenCDMImplementation does.
+    class ServerBuffer : public Exchange::DataExchange, public Core::Thread {
+    public:
+        ServerBuffer() = delete;
+        ServerBuffer(const ServerBuffer&) = delete;
+        ServerBuffer& operator=(const ServerBuffer&) = delete;
+
+        ServerBuffer(const string& name)
+            : Exchange::DataExchange(name, BufferSize)
+            , Core::Thread(Core::Thread::DefaultStackSize(), _T("OCDMBenchBuffer"))
+            , _clearKey()
+        {
+            Run();
+        }
+        ~ServerBuffer() override
+        {
+            Block();
+            Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            if (RequestConsume(100) == Core::ERROR_NONE) {
+                CDMi::EncryptionPattern pattern = { 0, 0 };
+                EncPattern(pattern.encrypted_blocks, pattern.clear_blocks);
+
+                Status(_clearKey.Decrypt(static_cast<CDMi::EncryptionScheme>(EncScheme()), pattern,
+                    IVKeyLength(), IVKey(),
+                    SubSampleLength(), reinterpret_cast<const CDMi::SubSampleInfo*>(SubSampleData()),
+                    BytesWritten(), Buffer()));
+
+                Consumed();
+            }
+
+            return (0);
+        }
+
+    private:
+        ClearKey _clearKey;
+    };
+
+    class Session : public Exchange::ISession {
+    public:
+        Session() = delete;
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        Session(const string& sessionId, Exchange::ISession::ICallback* callback)
+            : _adminLock()
+            , _sessionId(sessionId)
+            , _callback(callback)
+            , _buffer(nullptr)
+            , _status(Exchange::ISession::StatusPending)
+        {
+            if (_callback != nullptr) {
+                _callback->AddRef();
+            }
+        }
+        ~Session() override
+        {
+            if (_callback != nullptr) {
+                _callback->Release();
+            }
+            delete _buffer;
+        }
+
+    public:
+        Exchange::OCDM_RESULT Load() override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+        // Any license will do, the one key becomes usable.
+        void Update(const uint8_t*, const uint16_t) override
+        {
+            _adminLock.Lock();
+
+            _status = Exchange::ISession::Usable;
+
+            if (_callback != nullptr) {
+                _callback->OnKeyStatusUpdate(KeyId, sizeof(KeyId), _status);
+                _callback->OnKeyStatusesUpdated();
+            }
+
+            _adminLock.Unlock();
+        }
+        Exchange::OCDM_RESULT Remove() override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT Metricdata(uint32_t& bufferSize, uint8_t[]) override
+        {
+            bufferSize = 0;
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::ISession::KeyStatus Status() const override
+        {
+            return (_status);
+        }
+        Exchange::ISession::KeyStatus Status(const uint8_t keyID[], const uint8_t keyIDLength) const override
+        {
+            return (((keyIDLength == sizeof(KeyId)) && (::memcmp(keyID, KeyId, sizeof(KeyId)) == 0)) ? _status : Exchange::ISession::StatusPending);
+        }
+        string SessionId() const override
+        {
+            return (_sessionId);
+        }
+        string Metadata() const override
+        {
+            return (string());
+        }
+        void Close() override
+        {
+        }
+        void ResetOutputProtection() override
+        {
+        }
+        void SetParameter(const string&, const string&) override
+        {
+        }
+        void Revoke(Exchange::ISession::ICallback* callback) override
+        {
+            _adminLock.Lock();
+
+            if ((_callback != nullptr) && (_callback == callback)) {
+                _callback->Release();
+                _callback = nullptr;
+            }
+
+            _adminLock.Unlock();
+        }
+        uint32_t CreateSessionBuffer(string& bufferID) override
+        {
+            _adminLock.Lock();
+
+            if (_buffer == nullptr) {
+                _buffer = new ServerBuffer(Core::Directory::Normalize(Core::SystemInfo::Instance().TemporaryDirectory()) + _T("ocdmbench-") + _sessionId);
+            }
+
+            bufferID = _buffer->Name();
+
+            _adminLock.Unlock();
+
+            return (0);
+        }
+
+        BEGIN_INTERFACE_MAP(Session)
+        INTERFACE_ENTRY(Exchange::ISession)
+        END_INTERFACE_MAP
+
+    private:
+        Core::CriticalSection _adminLock;
+        const string _sessionId;
+        Exchange::ISession::ICallback* _callback;
+        ServerBuffer* _buffer;
+        Exchange::ISession::KeyStatus _status;
+    };
+
+    // Stand-in for the OpenCDMImplementation, it only supports creating
+    // sessions for the bench key system.
+    class Accessor : public Exchange::IAccessorOCDM {
+    public:
+        Accessor(const Accessor&) = delete;
+        Accessor& operator=(const Accessor&) = delete;
+
+        Accessor()
+            : _sessions(0)
+        {
+        }
+        ~Accessor() override = default;
+
+    public:
+        bool IsTypeSupported(const string& keySystem, const string&) const override
+        {
+            return (keySystem == _T("org.rdk.ocdmbench"));
+        }
+        Exchange::OCDM_RESULT Metadata(const string&, string& metadata) const override
+        {
+            metadata.clear();
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT Metricdata(const string&, uint32_t& length, uint8_t[]) const override
+        {
+            length = 0;
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT CreateSession(const string& keySystem, const int32_t,
+            const std::string&, const uint8_t*, const uint16_t, const uint8_t*, const uint16_t,
+            Exchange::ISession::ICallback* callback, std::string& sessionId,
+            Exchange::ISession*& session) override
+        {
+            Exchange::OCDM_RESULT result = Exchange::OCDM_RESULT::OCDM_KEYSYSTEM_NOT_SUPPORTED;
+
+            if (IsTypeSupported(keySystem, string()) == true) {
+                sessionId = Core::NumberType<uint32_t>(++_sessions).Text();
+                session = Core::ServiceType<Session>::Create<Exchange::ISession>(sessionId, callback);
+                result = Exchange::OCDM_RESULT::OCDM_SUCCESS;
+            }
+
+            return (result);
+        }
+        Exchange::OCDM_RESULT SetServerCertificate(const string&, const uint8_t*, const uint16_t) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        uint64_t GetDrmSystemTime(const std::string&) const override
+        {
+            return (Core::Time::Now().Ticks());
+        }
+        std::string GetVersionExt(const std::string&) const override
+        {
+            return (_T("ocdmbench"));
+        }
+        uint32_t GetLdlSessionLimit(const std::string&) const override
+        {
+            return (0);
+        }
+        bool IsSecureStopEnabled(const std::string&) override
+        {
+            return (false);
+        }
+        Exchange::OCDM_RESULT EnableSecureStop(const std::string&, bool) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+        uint32_t ResetSecureStops(const std::string&) override
+        {
+            return (0);
+        }
+        Exchange::OCDM_RESULT GetSecureStopIds(const std::string&, uint8_t[], uint16_t, uint32_t& count) override
+        {
+            count = 0;
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT GetSecureStop(const std::string&, const uint8_t[], uint16_t, uint8_t[], uint16_t& rawSize) override
+        {
+            rawSize = 0;
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+        Exchange::OCDM_RESULT CommitSecureStop(const std::string&, const uint8_t[], uint16_t, const uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+        Exchange::OCDM_RESULT DeleteKeyStore(const std::string&) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT DeleteSecureStore(const std::string&) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_SUCCESS);
+        }
+        Exchange::OCDM_RESULT GetKeyStoreHash(const std::string&, uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+        Exchange::OCDM_RESULT GetSecureStoreHash(const std::string&, uint8_t[], uint16_t) override
+        {
+            return (Exchange::OCDM_RESULT::OCDM_S_FALSE);
+        }
+
+        BEGIN_INTERFACE_MAP(Accessor)
+        INTERFACE_ENTRY(Exchange::IAccessorOCDM)
+        END_INTERFACE_MAP
+
+    private:
+        std::atomic<uint32_t> _sessions;
+    };
+
+    // Hands out the Accessor to whoever asks for "OpenCDMImplementation".
+    class Server : public RPC::Communicator {
+    public:
+        Server() = delete;
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        Server(const Core::NodeId& node, const string& proxyStubPath)
+            : RPC::Communicator(node, proxyStubPath, Core::ProxyType<Core::IIPCServer>(Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create()))
+            , _accessor(Core::ServiceType<Accessor>::Create<Exchange::IAccessorOCDM>())
+        {
+            Open(Core::infinite);
+        }
+        ~Server() override
+        {
+            Close(Core::infinite);
+            _accessor->Release();
+        }
+
+    private:
+        void* Acquire(const string& className, const uint32_t interfaceId, const uint32_t) override
+        {
+            void* result = nullptr;
+
+            if ((className == _T("OpenCDMImplementation")) && (interfaceId == Exchange::IAccessorOCDM::ID)) {
+                _accessor->AddRef();
+                result = _accessor;
+            }
+
+            return (result);
+        }
+
+    private:
+        Exchange::IAccessorOCDM* _accessor;
+    };
+
+    struct Config {
+        uint32_t SampleSize;
+        uint32_t SubSamples;
+        uint16_t ClearBytes;
+        EncryptionScheme Scheme;
+        uint32_t Sessions;
+        uint32_t Threads;
+        uint32_t Seconds;
+    };
+
+    struct Result {
+        uint64_t Samples;
+        uint32_t Failures;
+        std::vector<uint32_t> Latencies;
+    };
+
+    void Decryptor(struct OpenCDMSession* session, const Config& config, const uint64_t deadline, Result& result)
+    {
+        std::vector<uint8_t> sample(config.SampleSize, 0xA5);
+        std::vector<SubSampleInfo> subSamples(config.SubSamples);
+
+        // Every subsample starts with "ClearBytes" in the clear, the rest of
+        // the sample is divided over the encrypted ranges.
+        if (config.SubSamples > 0) {
+            const uint32_t encrypted = (config.SampleSize / config.SubSamples) - config.ClearBytes;
+
+            for (uint32_t index = 0; index < config.SubSamples; index++) {
+                subSamples[index].clear_bytes = config.ClearBytes;
+                subSamples[index].encrypted_bytes = (index == (config.SubSamples - 1) ? (config.SampleSize - (index * (config.ClearBytes + encrypted)) - config.ClearBytes) : encrypted);
+            }
+        }
+
+        SampleInfo info;
+        info.scheme = config.Scheme;
+        info.pattern = (config.Scheme == AesCbc_Cbcs ? EncryptionPattern({ 1, 9 }) : EncryptionPattern({ 0, 0 }));
+        info.iv = const_cast<uint8_t*>(IV);
+        info.ivLength = (config.Scheme == AesCbc_Cbcs ? sizeof(IV) : 8);
+        info.keyId = const_cast<uint8_t*>(KeyId);
+        info.keyIdLength = sizeof(KeyId);
+        info.subSampleCount = static_cast<uint8_t>(config.SubSamples);
+        info.subSample = (config.SubSamples > 0 ? subSamples.data() : nullptr);
+
+        MediaProperties properties = { 2160, 3840, MediaType_Video };
+
+        while (Core::Time::Now().Ticks() < deadline) {
+            const Stopwatch stopwatch;
+
+            if (opencdm_session_decrypt_v2(session, sample.data(), config.SampleSize, &info, &properties) == ERROR_NONE) {
+                result.Latencies.push_back(static_cast<uint32_t>(stopwatch.Microseconds()));
+                result.Samples++;
+            } else {
+                result.Failures++;
+            }
+        }
+    }
+
+    uint32_t Percentile(const std::vector<uint32_t>& sorted, const double percentile)
+    {
+        return (sorted.empty() == true ? 0 : sorted[std::min(static_cast<size_t>(sorted.size() * percentile), sorted.size() - 1)]);
+    }
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    cout << "[sample size, default 16384] [subsamples, default 0] [clear bytes, default 128] [cenc|cbcs, default cenc] "
+            "[sessions, default 1] [threads per session, default 1] [seconds, default 5] [proxystub path, default /usr/lib/thunder/proxystubs]" << endl;
+
+    Config config;
+    config.SampleSize = (argc > 1 ? atoi(argv[1]) : 16384);
+    config.SubSamples = (argc > 2 ? atoi(argv[2]) : 0);
+    config.ClearBytes = static_cast<uint16_t>(argc > 3 ? atoi(argv[3]) : 128);
+    config.Scheme = ((argc > 4) && (string(argv[4]) == _T("cbcs")) ? AesCbc_Cbcs : AesCtr_Cenc);
+    config.Sessions = (argc > 5 ? atoi(argv[5]) : 1);
+    config.Threads = (argc > 6 ? atoi(argv[6]) : 1);
+    config.Seconds = (argc > 7 ? atoi(argv[7]) : 5);
+    const string proxyStubPath(argc > 8 ? argv[8] : _T("/usr/lib/thunder/proxystubs"));
+
+    if ((config.SampleSize == 0) || (config.SampleSize > BufferSize) || (config.SubSamples > 255) || (config.Sessions == 0) || (config.Threads == 0)
+        || ((config.SubSamples > 0) && ((config.SampleSize / config.SubSamples) <= config.ClearBytes))) {
+        cout << "invalid args" << endl;
+        return -1;
+    }
+
+    const string connector(Core::Directory::Normalize(Core::SystemInfo::Instance().TemporaryDirectory()) + _T("ocdmbench"));
+
+    // The client library picks the server up from the environment on first use.
+    Core::SystemInfo::SetEnvironment(_T("OPEN_CDM_SERVER"), connector);
+
+    {
+        Server server(Core::NodeId(connector.c_str()), proxyStubPath);
+
+        struct OpenCDMSystem* system = opencdm_create_system("org.rdk.ocdmbench");
+        std::vector<struct OpenCDMSession*> sessions;
+
+        if (system == nullptr) {
+            cout << "ocdm system could not be created" << endl;
+        } else {
+            for (uint32_t index = 0; index < config.Sessions; index++) {
+                struct OpenCDMSession* session = nullptr;
+
+                if ((opencdm_construct_session(system, Temporary, "cenc", nullptr, 0, nullptr, 0, Callbacks(), nullptr, &session) != ERROR_NONE) || (session == nullptr)) {
+                    cout << "ocdm session could not be created" << endl;
+                    break;
+                }
+
+                sessions.push_back(session);
+
+                opencdm_session_update(session, KeyId, sizeof(KeyId));
+
+                WaitForKey(session);
+            }
+        }
+
+        if ((sessions.size() == config.Sessions) && (config.Sessions > 0)) {
+            std::vector<Result> results(config.Sessions * config.Threads);
+            std::vector<std::thread> threads;
+
+            cout << "sample: " << config.SampleSize << " bytes, " << config.SubSamples << " subsamples, " << config.ClearBytes << " clear bytes each, "
+                 << (config.Scheme == AesCbc_Cbcs ? "cbcs" : "cenc") << ", " << config.Sessions << " sessions, " << config.Threads << " threads per session" << endl;
+
+            const Stopwatch stopwatch;
+            const uint64_t deadline = Deadline(config.Seconds);
+
+            for (uint32_t index = 0; index < results.size(); index++) {
+                results[index].Samples = 0;
+                results[index].Failures = 0;
+                results[index].Latencies.reserve(1024 * 1024);
+                threads.emplace_back(Decryptor, sessions[index / config.Threads], std::cref(config), deadline, std::ref(results[index]));
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            const double elapsed = stopwatch.Seconds();
+            std::vector<uint32_t> latencies;
+            uint64_t samples = 0;
+            uint32_t failures = 0;
+
+            for (const Result& result : results) {
+                samples += result.Samples;
+                failures += result.Failures;
+                latencies.insert(latencies.end(), result.Latencies.begin(), result.Latencies.end());
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+
+            Report("total:", samples, failures, config.SampleSize, elapsed);
+            cout << "latency us p50: " << Percentile(latencies, 0.5)
+                 << " p99: " << Percentile(latencies, 0.99)
+                 << " p999: " << Percentile(latencies, 0.999) << endl;
+        }
+
+        for (struct OpenCDMSession* session : sessions) {
+            opencdm_destruct_session(session);
+        }
+
+        if (system != nullptr) {
+            opencdm_destruct_system(system);
+        }
+
+        opencdm_dispose();
+    }
+
+    Core::Singleton::Dispose();
+
+    return 0;
+}
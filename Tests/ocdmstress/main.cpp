@@ -0,0 +1,131 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2021 Metrological
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME OpenCDMStress
+#endif
+
+#include "ClearKeyFixture.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace Thunder;
+using namespace OCDMTest;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    void Decryptor(struct OpenCDMSession* session, const uint32_t sampleSize, const uint64_t deadline,
+        std::atomic<uint64_t>& samples, std::atomic<uint32_t>& failures)
+    {
+        std::vector<uint8_t> sample(sampleSize, 0xA5);
+
+        SampleInfo info;
+        info.scheme = AesCtr_Cenc;
+        info.pattern = { 0, 0 };
+        info.iv = const_cast<uint8_t*>(IV);
+        info.ivLength = sizeof(IV);
+        info.keyId = const_cast<uint8_t*>(KeyId);
+        info.keyIdLength = sizeof(KeyId);
+        info.subSampleCount = 0;
+        info.subSample = nullptr;
+
+        MediaProperties properties = { 2160, 3840, MediaType_Video };
+
+        while (Core::Time::Now().Ticks() < deadline) {
+            if (opencdm_session_decrypt_v2(session, sample.data(), sampleSize, &info, &properties) == ERROR_NONE) {
+                samples++;
+            } else {
+                failures++;
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    cout << "<keysystem> <max sessions> [seconds per run, default 5] [sample size, default 16384]" << endl;
+
+    if (argc < 3) {
+        cout << "invalid args" << endl;
+        return -1;
+    }
+
+    const uint32_t maxSessions = atoi(argv[2]);
+    const uint32_t seconds = (argc > 3 ? atoi(argv[3]) : 5);
+    const uint32_t sampleSize = (argc > 4 ? atoi(argv[4]) : 16384);
+
+    struct OpenCDMSystem* system = opencdm_create_system(argv[1]);
+
+    if (system == nullptr) {
+        cout << "ocdm system could not be created" << endl;
+        return -1;
+    }
+
+    for (uint32_t count = 1; count <= maxSessions; count++) {
+        std::vector<struct OpenCDMSession*> sessions;
+
+        for (uint32_t index = 0; index < count; index++) {
+            struct OpenCDMSession* session = OpenSession(system);
+
+            if (session == nullptr) {
+                break;
+            }
+
+            sessions.push_back(session);
+        }
+
+        if (sessions.size() == count) {
+            std::atomic<uint64_t> samples(0);
+            std::atomic<uint32_t> failures(0);
+            std::vector<std::thread> threads;
+
+            const Stopwatch stopwatch;
+            const uint64_t deadline = Deadline(seconds);
+
+            for (struct OpenCDMSession* session : sessions) {
+                threads.emplace_back(Decryptor, session, sampleSize, deadline, std::ref(samples), std::ref(failures));
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            Report("sessions: " + std::to_string(count), samples.load(), failures.load(), sampleSize, stopwatch.Seconds());
+        }
+
+        for (struct OpenCDMSession* session : sessions) {
+            opencdm_destruct_session(session);
+        }
+
+        if (sessions.size() != count) {
+            break;
+        }
+    }
+
+    opencdm_destruct_system(system);
+    opencdm_dispose();
+
+    return 0;
+}